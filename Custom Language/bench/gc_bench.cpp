@@ -0,0 +1,220 @@
+// gc_bench.cpp
+// Allocation-heavy collector benchmark. Allocates mostly short-lived objects
+// of mixed sizes (with the odd large one), keeps a random subset reachable
+// through a rooted table, and leaves collecting to the pacer, or with
+// collectMB set collects every that many megabytes itself. Reports allocation
+// throughput, collection pauses and how much memory the heap holds on to
+// compared with the payload that is actually live. Run with AWARA_GC_PERCENT
+// or AWARA_GC_MEMORY_LIMIT set to trade one for the other, and with
+// AWARA_GC_NURSERY set to measure the generational mode; minor collections
+// then happen on their own between the full ones.
+//
+// With threads > 1 the allocations are split across that many mutators, each
+// with its own table and collecting every collectMB of its own allocation, so
+// the number of collections stays the same.
+//
+// Usage: gc_bench [allocations=5000000] [live=65536] [collectMB=0 (paced)] [threads=1]
+#include "gc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using CustomLang::GarbageCollector;
+
+namespace {
+
+    struct Random {
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        uint64_t next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double seconds(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    size_t peakResidentKb() {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmHWM:") == 0) return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+        return 0;
+    }
+
+    struct Mutator {
+        void** table = nullptr;
+        size_t collections = 0;
+        double pauseTotal = 0.0;
+        double pauseMax = 0.0;
+        bool failed = false;
+    };
+
+    void run(Mutator& mutator, size_t allocations, uint32_t live, size_t collectBytes, uint64_t seed) {
+        GarbageCollector& gc = GarbageCollector::getInstance();
+        Random random;
+        random.state ^= seed;
+
+        // Everything that survives is reachable from here
+        void** table = static_cast<void**>(gc.allocateOld(live * sizeof(void*), live));
+        gc.addRoot(table);
+        mutator.table = table;
+
+        size_t bytesSinceCollect = 0;
+        for (size_t i = 0; i < allocations; ++i) {
+            uint64_t r = random.next();
+
+            size_t size = 8 + (r & 0xF8);                    // 8..256 bytes
+            if ((r >> 8) % 4096 == 0) size = 8192 + ((r >> 20) & 0x7FFF);
+            uint32_t references = (r >> 40) % 4 == 0 ? 1 : 0;
+
+            void* object = gc.allocate(size, references);
+            if (!object) {
+                std::cerr << "allocation failed after " << i << " objects\n";
+                mutator.failed = true;
+                return;
+            }
+            bytesSinceCollect += size;
+
+            // One in eight survives until its table slot is reused; some of
+            // them keep the previous occupant alive a little longer
+            if ((r >> 32) % 8 == 0) {
+                void*& slot = table[(r >> 44) % live];
+                if (references) {
+                    static_cast<void**>(object)[0] = slot;
+                    gc.writeBarrier(object, slot);
+                }
+                gc.preWriteBarrier(slot);
+                slot = object;
+                gc.writeBarrier(table, object);
+            }
+
+            if (collectBytes && bytesSinceCollect >= collectBytes) {
+                auto pauseStart = Clock::now();
+                gc.collect();
+                double pause = seconds(pauseStart, Clock::now());
+                mutator.pauseTotal += pause;
+                mutator.pauseMax = std::max(mutator.pauseMax, pause);
+                ++mutator.collections;
+                bytesSinceCollect = 0;
+            }
+        }
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t allocations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    uint32_t live = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 65536;
+    size_t collectBytes = (argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0) << 20;
+    unsigned threadCount = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+
+    GarbageCollector& gc = GarbageCollector::getInstance();
+    if (collectBytes) {
+        gc.setGCPercent(-1);
+    }
+    std::vector<Mutator> mutators(threadCount);
+
+    auto start = Clock::now();
+    if (threadCount == 1) {
+        run(mutators[0], allocations, live, collectBytes, 0);
+    }
+    else {
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; ++t) {
+            threads.emplace_back(run, std::ref(mutators[t]), allocations / threadCount, live,
+                                 collectBytes, t + 1);
+        }
+        // Joining blocks; don't hold up the workers' collections meanwhile
+        GarbageCollector::SafeRegion blocking;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    double total = seconds(start, Clock::now());
+    // Collections stop every thread, so their time comes off the wall clock once
+    GarbageCollector::Stats running = gc.stats();
+    double mutatorSeconds = total - running.fullSeconds - running.minorSeconds;
+
+    size_t collections = 0;
+    double pauseTotal = 0.0;
+    double pauseMax = 0.0;
+    for (const Mutator& mutator : mutators) {
+        if (mutator.failed) return 1;
+        collections += mutator.collections;
+        pauseTotal += mutator.pauseTotal;
+        pauseMax = std::max(pauseMax, mutator.pauseMax);
+    }
+
+    auto finalStart = Clock::now();
+    gc.collect();
+    double collectTotal = seconds(finalStart, Clock::now());
+
+    // Payload the program can still reach. Each object is referenced from at
+    // most one place (a slot or its successor), so chains never overlap.
+    size_t livePayload = 0;
+    for (const Mutator& mutator : mutators) {
+        livePayload += live * sizeof(void*);
+        for (uint32_t i = 0; i < live; ++i) {
+            void* object = mutator.table[i];
+            while (object) {
+                CustomLang::ObjectHeader* header = static_cast<CustomLang::ObjectHeader*>(object) - 1;
+                livePayload += header->size;
+                object = header->references ? header->referenceSlots()[0] : nullptr;
+            }
+        }
+    }
+
+    GarbageCollector::Stats gcStats = gc.stats();
+    const CustomLang::Heap::Stats& stats = gcStats.heap;
+
+    std::cout << "Threads:          " << threadCount << "\n"
+              << "Allocations:      " << allocations << " (" << stats.allocatedBytes / (1024 * 1024)
+              << " MB reached the old space)\n"
+              << "Throughput:       " << allocations / total / 1e6 << " Mallocs/s overall, "
+              << allocations / mutatorSeconds / 1e6 << " Mallocs/s between collections\n"
+              << "Collections:      ";
+    if (collectBytes) {
+        std::cout << collections << ", mean pause " << (collections ? pauseTotal / collections * 1e3 : 0.0)
+                  << " ms, max " << pauseMax * 1e3 << " ms, final " << collectTotal * 1e3 << " ms\n";
+    }
+    else {
+        std::cout << running.pacedCycles << " paced, " << 100.0 * running.fullSeconds / total
+                  << "% of the time in them; goal ";
+        if (running.heapGoal == SIZE_MAX) {
+            std::cout << "none\n";
+        }
+        else {
+            std::cout << running.heapGoal / (1024 * 1024) << " MB for " << running.markedBytes / (1024 * 1024)
+                      << " MB marked\n";
+        }
+    }
+    std::cout << "Peak resident:    " << peakResidentKb() / 1024 << " MB\n"
+              << "Heap after final: " << stats.committedBytes / 1024 << " KB committed in " << stats.pages
+              << " pages + " << stats.largeObjects << " large, " << stats.liveBytes / 1024 << " KB in live cells\n"
+              << "Live payload:     " << livePayload / 1024 << " KB ("
+              << 100.0 * (1.0 - static_cast<double>(livePayload) / stats.committedBytes) << "% of committed is overhead)\n";
+    if (gcStats.nurseryBytes) {
+        std::cout << "Nursery:          " << gcStats.nurseryBytes / 1024 << " KB eden, " << gcStats.minorCollections
+                  << " minor collections, mean pause "
+                  << (gcStats.minorCollections ? gcStats.minorSeconds / gcStats.minorCollections * 1e3 : 0.0) << " ms\n"
+                  << "Copied:           " << gcStats.survivorBytes / (1024 * 1024) << " MB within the nursery, "
+                  << gcStats.promotedBytes / (1024 * 1024) << " MB promoted\n";
+    }
+
+    for (const Mutator& mutator : mutators) {
+        gc.removeRoot(mutator.table);
+    }
+    return 0;
+}
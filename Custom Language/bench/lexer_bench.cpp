@@ -0,0 +1,78 @@
+// lexer_bench.cpp
+// Lexer throughput benchmark: lexes a generated .awara module several times
+// and reports MB/s, tokens/s and how many heap allocations the lexer made.
+//
+// Usage: lexer_bench [functions=20000] [iterations=10]
+#include "lexer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Count every global allocation so we can see what lexing costs
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// Roughly what our generated modules look like
+static std::string generateSource(int functions) {
+    std::string source;
+    for (int i = 0; i < functions; ++i) {
+        source += "dekh generated_function_" + std::to_string(i) + "() {\n";
+        source += "    dikha \"value number " + std::to_string(i) + " from the generator\"\n";
+        source += "    bhai \"escaped \\\"quote\\\"\" aur khali ya " + std::to_string(i * 7) + "\n";
+        source += "}\n\n";
+    }
+    return source;
+}
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    const std::string source = generateSource(functions);
+
+    size_t tokens = 0;
+    size_t allocations = 0;
+    double seconds = 0.0;
+
+    for (int i = 0; i < iterations; ++i) {
+        CustomLang::Lexer lexer(source);
+
+        size_t before = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        while (lexer.nextToken().type != CustomLang::TokenType::EOF_TOKEN) {
+            ++tokens;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        allocations += allocationCount.load(std::memory_order_relaxed) - before;
+        seconds += std::chrono::duration<double>(end - start).count();
+    }
+
+    double megabytes = static_cast<double>(source.size()) * iterations / (1024.0 * 1024.0);
+
+    std::cout << "Source size:      " << source.size() << " bytes\n"
+              << "Tokens per pass:  " << tokens / iterations << "\n"
+              << "Throughput:       " << megabytes / seconds << " MB/s, "
+              << tokens / seconds / 1e6 << " Mtokens/s\n"
+              << "Allocations:      " << allocations / iterations << " per pass ("
+              << static_cast<double>(allocations) / tokens << " per token)\n";
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+// mark_bench.cpp
+// Mark-phase scaling benchmark. Builds a balanced binary tree of small
+// objects hanging off one root, then runs full collections and reports how
+// long marking took. Everything is live, so sweeping frees nothing and the
+// mark time is the interesting part. Compare thread counts by running it
+// once per count; the marker threads are fixed when the collector starts.
+//
+// Usage: mark_bench [objects=1000000] [threads=0 (one per hardware thread)] [collections=5]
+#include "gc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using CustomLang::GarbageCollector;
+
+namespace {
+
+    // Fills the subtree under parent's slot with count objects, depth first.
+    // Each child is linked in before the next allocation, so the tree stays
+    // reachable from the root while it grows.
+    void build(GarbageCollector& gc, void** slot, size_t count) {
+        struct Pending {
+            void** slot;
+            size_t count;
+        };
+        std::vector<Pending> pending{ { slot, count } };
+
+        while (!pending.empty()) {
+            Pending next = pending.back();
+            pending.pop_back();
+            if (next.count == 0) continue;
+
+            void** node = static_cast<void**>(gc.allocateOld(2 * sizeof(void*), 2));
+            if (!node) {
+                std::cerr << "allocation failed\n";
+                std::exit(1);
+            }
+            *next.slot = node;
+
+            size_t left = (next.count - 1) / 2;
+            pending.push_back({ &node[1], next.count - 1 - left });
+            pending.push_back({ &node[0], left });
+        }
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t objects = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string threads = argc > 2 ? argv[2] : "0";
+    int collections = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5;
+
+    setenv("AWARA_GC_THREADS", threads.c_str(), 1);
+    GarbageCollector& gc = GarbageCollector::getInstance();
+    gc.setGCPercent(-1);    // collections happen where this benchmark says
+
+    void** root = static_cast<void**>(gc.allocateOld(sizeof(void*), 1));
+    gc.addRoot(root);
+
+    auto buildStart = std::chrono::steady_clock::now();
+    build(gc, &root[0], objects);
+    double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+
+    std::vector<double> markTimes;
+    double fullTotal = 0.0;
+    for (int i = 0; i < collections; ++i) {
+        GarbageCollector::Stats before = gc.stats();
+        gc.collect();
+        GarbageCollector::Stats after = gc.stats();
+        markTimes.push_back(after.markSeconds - before.markSeconds);
+        fullTotal += after.fullSeconds - before.fullSeconds;
+    }
+    std::sort(markTimes.begin(), markTimes.end());
+
+    GarbageCollector::Stats stats = gc.stats();
+    std::cout << "Objects:      " << objects << " (" << stats.heap.liveBytes / (1024 * 1024) << " MB live, built in "
+              << buildSeconds << " s)\n"
+              << "Mark threads: " << stats.markThreads << "\n"
+              << "Mark time:    " << markTimes.front() * 1e3 << " ms best, " << markTimes[markTimes.size() / 2] * 1e3
+              << " ms median of " << collections << "\n"
+              << "Full pause:   " << fullTotal / collections * 1e3 << " ms mean (mark + sweep)\n";
+
+    gc.removeRoot(root);
+    return 0;
+}
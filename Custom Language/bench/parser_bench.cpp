@@ -0,0 +1,84 @@
+// parser_bench.cpp
+// Compares lex+parse time of the streaming parser (tokens pulled from the
+// lexer one at a time) and the batched parser (whole file lexed into a
+// TokenBuffer first, then parsed by index), plus the batched parse split
+// across a thread pool at top-level declarations.
+//
+// Usage: parser_bench [functions=20000] [iterations=10] [jobs=hardware threads]
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+#include "token_buffer.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Roughly what our generated modules look like
+static std::string generateSource(int functions) {
+    std::string source;
+    for (int i = 0; i < functions; ++i) {
+        source += "dekh generated_function_" + std::to_string(i) + "(count int, label string) {\n";
+        source += "    dikha \"value number " + std::to_string(i) + " from the generator\"\n";
+        source += "    bhai \"escaped \\\"quote\\\"\" aur khali ya " + std::to_string(i * 7) + "\n";
+        source += "}\n\n";
+    }
+    return source;
+}
+
+template <typename Body>
+static double timeIt(int iterations, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+    unsigned jobs = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0;
+
+    const std::string source = generateSource(functions);
+    size_t statements = 0;
+
+    double streaming = timeIt(iterations, [&] {
+        CustomLang::AstArena arena;
+        CustomLang::Parser parser(CustomLang::Lexer(source), arena);
+        statements = parser.parse().size();
+    });
+
+    double lexing = 0.0;
+    double parsing = 0.0;
+    double batched = timeIt(iterations, [&] {
+        auto start = std::chrono::steady_clock::now();
+        CustomLang::TokenBuffer tokens = CustomLang::TokenBuffer::lex(source);
+        auto lexed = std::chrono::steady_clock::now();
+
+        CustomLang::AstArena arena;
+        CustomLang::Parser parser(tokens, arena);
+        statements = parser.parse().size();
+
+        lexing += std::chrono::duration<double>(lexed - start).count();
+        parsing += std::chrono::duration<double>(std::chrono::steady_clock::now() - lexed).count();
+    });
+
+    CustomLang::ThreadPool pool(jobs);
+    CustomLang::TokenBuffer tokens = CustomLang::TokenBuffer::lex(source);
+    double parallel = timeIt(iterations, [&] {
+        CustomLang::AstArena arena;
+        statements = CustomLang::parseParallel(tokens, arena, pool).size();
+    });
+
+    double megabytes = static_cast<double>(source.size()) / (1024.0 * 1024.0);
+
+    std::cout << "Source size:  " << source.size() << " bytes, " << statements << " top-level statements\n"
+              << "Streaming:    " << streaming * 1000.0 << " ms (" << megabytes / streaming << " MB/s)\n"
+              << "Batched:      " << batched * 1000.0 << " ms (" << megabytes / batched << " MB/s)"
+              << " = lex " << lexing / iterations * 1000.0 << " ms + parse "
+              << parsing / iterations * 1000.0 << " ms\n"
+              << "Parallel:     parse " << parallel * 1000.0 << " ms on " << pool.size() << " threads ("
+              << parsing / iterations / parallel << "x)\n";
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// pause_bench.cpp
+// Collector pause-time benchmark. Builds a large live tree, then allocates
+// short-lived objects and swaps random leaves of the tree for new ones,
+// starting a collection cycle every few megabytes. Every call into the
+// collector is timed and any that takes longer than PAUSE_THRESHOLD counts
+// as a pause; the report gives their percentiles next to the throughput.
+// Run it twice to compare the modes:
+//
+//     pause_bench                       one stop-the-world pause per cycle
+//     AWARA_GC_PAUSE_MS=1 pause_bench   incremental marking, 1 ms budget
+//
+// Usage: pause_bench [live=2000000] [allocations=20000000] [cycleMB=64]
+#include "gc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using CustomLang::GarbageCollector;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Shorter calls are ordinary allocations
+    constexpr std::chrono::microseconds PAUSE_THRESHOLD(50);
+
+    struct Random {
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        uint64_t next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+    };
+
+    struct Timer {
+        std::vector<double> pauses;     // milliseconds
+
+        template <typename F>
+        auto operator()(F call) {
+            auto start = Clock::now();
+            auto result = call();
+            auto elapsed = Clock::now() - start;
+            if (elapsed >= PAUSE_THRESHOLD) {
+                pauses.push_back(std::chrono::duration<double, std::milli>(elapsed).count());
+            }
+            return result;
+        }
+    };
+
+    void* allocate(GarbageCollector& gc, Timer& timer, size_t size, uint32_t references) {
+        void* object = timer([&] { return gc.allocateOld(size, references); });
+        if (!object) {
+            std::cerr << "allocation failed\n";
+            std::exit(1);
+        }
+        return object;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t live = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    size_t allocations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000;
+    size_t cycleBytes = (argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64) << 20;
+
+    GarbageCollector& gc = GarbageCollector::getInstance();
+    gc.setGCPercent(-1);    // collections happen where this benchmark says
+    Random random;
+    Timer timer;
+
+    // A complete binary tree stored heap-style: node i's children are
+    // 2i+1 and 2i+2. The index only finds leaves; the tree itself is what
+    // the collector traces.
+    std::vector<void**> nodes(live);
+    for (size_t i = 0; i < live; ++i) {
+        nodes[i] = static_cast<void**>(allocate(gc, timer, 2 * sizeof(void*), 2));
+        if (i > 0) {
+            nodes[(i - 1) / 2][(i - 1) % 2] = nodes[i];
+        }
+    }
+    gc.addRoot(nodes[0]);
+    size_t firstLeaf = live / 2;
+
+    timer.pauses.clear();
+    size_t bytesSinceCycle = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < allocations; ++i) {
+        uint64_t r = random.next();
+        size_t size = 16 + (r & 0x70);
+        bytesSinceCycle += size;
+
+        // One in sixteen replaces a leaf, dropping the old one; the rest die young
+        if ((r >> 32) % 16 == 0 && firstLeaf < live) {
+            size_t leaf = firstLeaf + (r >> 36) % (live - firstLeaf);
+            void** parent = nodes[(leaf - 1) / 2];
+            void*& slot = parent[(leaf - 1) % 2];
+            void** object = static_cast<void**>(allocate(gc, timer, size, 2));
+            gc.preWriteBarrier(slot);
+            slot = object;
+            nodes[leaf] = object;
+        }
+        else {
+            allocate(gc, timer, size, 0);
+        }
+
+        if (bytesSinceCycle >= cycleBytes) {
+            timer([&] { gc.startCycle(); return 0; });
+            bytesSinceCycle = 0;
+        }
+    }
+    double total = std::chrono::duration<double>(Clock::now() - start).count();
+
+    GarbageCollector::Stats stats = gc.stats();
+    std::vector<double>& pauses = timer.pauses;
+    std::sort(pauses.begin(), pauses.end());
+    double pauseTotal = 0.0;
+    for (double pause : pauses) pauseTotal += pause;
+
+    const char* budget = std::getenv("AWARA_GC_PAUSE_MS");
+    std::cout << "Mode:        " << (budget ? "incremental, " : "stop-the-world") << (budget ? budget : "")
+              << (budget ? " ms budget" : "") << "\n"
+              << "Live:        " << live << " objects, " << stats.fullCollections << " cycles, "
+              << stats.markSlices << " mark slices\n"
+              << "Throughput:  " << allocations / total / 1e6 << " Mallocs/s, "
+              << 100.0 * pauseTotal / 1e3 / total << "% of the time paused\n"
+              << "Pauses:      " << pauses.size() << " over " << PAUSE_THRESHOLD.count() << " us; p50 "
+              << percentile(pauses, 0.50) << " ms, p99 " << percentile(pauses, 0.99) << " ms, max "
+              << (pauses.empty() ? 0.0 : pauses.back()) << " ms\n";
+
+    gc.removeRoot(nodes[0]);
+    return 0;
+}
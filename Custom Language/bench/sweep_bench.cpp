@@ -0,0 +1,111 @@
+// sweep_bench.cpp
+// Sweeping benchmark. Builds a heap of small objects that are all reachable,
+// drops most of them and collects, so nearly everything the heap holds has to
+// be swept. Reports how much of the pause went to marking and how resident
+// memory falls afterwards, once the background sweeper has given the empty
+// pages back to the OS.
+//
+// Usage: sweep_bench [peakMB=512] [keepPercent=5]
+#include "gc.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+using CustomLang::GarbageCollector;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    size_t residentBytes() {
+        size_t pages = 0, resident = 0;
+        if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+            if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2) resident = 0;
+            std::fclose(statm);
+        }
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    // Resident size once it has held still for a while, or after a few seconds
+    size_t settledResidentBytes() {
+        size_t last = residentBytes();
+        unsigned steady = 0;
+        auto deadline = Clock::now() + std::chrono::seconds(3);
+        while (steady < 4 && Clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            size_t now = residentBytes();
+            steady = now == last ? steady + 1 : 0;
+            last = now;
+        }
+        return last;
+    }
+
+    double seconds(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t peakBytes = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512) << 20;
+    unsigned keepPercent = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 5;
+
+    GarbageCollector& gc = GarbageCollector::getInstance();
+    gc.setGCPercent(-1);    // collections happen where this benchmark says
+
+    // Objects hang off one rooted table, each chain holding a stretch of
+    // consecutive allocations; only the first keepPercent of the chains
+    // outlive the peak
+    const uint32_t chains = 4096;
+    void** table = static_cast<void**>(gc.allocateOld(chains * sizeof(void*), chains));
+    gc.addRoot(table);
+
+    size_t bytes = 0;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    while (bytes < peakBytes) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size_t size = 16 + (state & 0xF0);
+
+        void** object = static_cast<void**>(gc.allocateOld(size, 1));
+        if (!object) {
+            std::cerr << "allocation failed\n";
+            return 1;
+        }
+        void*& slot = table[bytes * chains / peakBytes];
+        object[0] = slot;
+        slot = object;
+        bytes += size;
+    }
+
+    gc.collect();
+    size_t peakResident = residentBytes();
+    double markBefore = gc.stats().markSeconds;
+
+    for (uint32_t i = chains * keepPercent / 100; i < chains; ++i) {
+        table[i] = nullptr;
+    }
+
+    auto start = Clock::now();
+    gc.collect();
+    double pause = seconds(start, Clock::now());
+    size_t afterResident = settledResidentBytes();
+
+    GarbageCollector::Stats stats = gc.stats();
+    double mark = stats.markSeconds - markBefore;
+
+    std::cout << "Peak:      " << bytes / (1024 * 1024) << " MB allocated, " << peakResident / (1024 * 1024)
+              << " MB resident\n"
+              << "Collect:   " << pause * 1e3 << " ms pause dropping " << 100 - keepPercent
+              << "% of it, " << mark * 1e3 << " ms of it marking\n"
+              << "After:     " << afterResident / (1024 * 1024) << " MB resident, "
+              << stats.heap.committedBytes / (1024 * 1024) << " MB committed, " << stats.heap.releasedPages
+              << " of " << stats.heap.pages << " pages released\n";
+
+    gc.removeRoot(table);
+    return 0;
+}
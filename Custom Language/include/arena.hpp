@@ -0,0 +1,78 @@
+// arena.hpp
+// Bump allocator for AST nodes and the lists hanging off them. Everything is
+// released in one shot when the arena goes away; node destructors never run,
+// so nodes may only own memory that also lives in the arena.
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace CustomLang {
+
+    class AstArena : public std::pmr::memory_resource {
+    public:
+        explicit AstArena(size_t initialBlockSize = 64 * 1024);
+        ~AstArena() override = default;
+
+        AstArena(const AstArena&) = delete;
+        AstArena& operator=(const AstArena&) = delete;
+
+        // Construct a node in the arena
+        template <typename T, typename... Args>
+        T* create(Args&&... args) {
+            void* memory = allocate(sizeof(T), alignof(T));
+            nodeCount_++;
+            return ::new (memory) T(std::forward<Args>(args)...);
+        }
+
+        // Drop every node at once. Anything allocated from the arena is dead after this.
+        void release();
+
+        // Keep another arena's nodes alive as long as this one (e.g. one filled
+        // by a parser thread). It is released with this arena and counted in
+        // the statistics below.
+        void adopt(std::unique_ptr<AstArena> child);
+
+        // Measure time spent allocating (costs two clock reads per allocation)
+        void setTimed(bool timed) { timed_ = timed; }
+        bool timed() const { return timed_; }
+
+        size_t nodeCount() const;
+        size_t bytesUsed() const;
+        size_t bytesReserved() const;
+        double allocationSeconds() const;
+
+    private:
+        // Counts what the bump allocator takes from the heap
+        class UpstreamResource : public std::pmr::memory_resource {
+        public:
+            explicit UpstreamResource(size_t& reserved) : reserved_(reserved) {}
+
+        private:
+            size_t& reserved_;
+
+            void* do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+        };
+
+        size_t nodeCount_ = 0;
+        size_t bytesUsed_ = 0;
+        size_t bytesReserved_ = 0;
+        bool timed_ = false;
+        std::chrono::steady_clock::duration allocationTime_{};
+
+        UpstreamResource upstream_;
+        std::pmr::monotonic_buffer_resource buffer_;
+        std::vector<std::unique_ptr<AstArena>> children_;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+} // namespace CustomLang
@@ -1,8 +1,9 @@
 // ast.hpp
 #pragma once
-#include <string>
+#include "interner.hpp"
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
-#include <memory>
 
 namespace CustomLang {
 
@@ -28,6 +29,18 @@ namespace CustomLang {
         virtual ~Statement() = default;
     };
 
+    // Nodes are allocated from an AstArena (see arena.hpp) and are never
+    // destroyed individually: children are plain pointers and lists use the
+    // arena's memory resource. Names, types and literal values are interned
+    // SymbolIds (see interner.hpp).
+
+    using StatementList = std::pmr::vector<Statement*>;
+
+    enum class BinaryOp : uint8_t {
+        AUR,    // and
+        YA      // or
+    };
+
     // Literal expression (numbers, strings, etc.)
     class LiteralExpr : public Expression {
     public:
@@ -39,10 +52,10 @@ namespace CustomLang {
         };
 
         LiteralType type;
-        std::string value;
+        SymbolId value;
 
-        LiteralExpr(LiteralType t, std::string v)
-            : type(t), value(std::move(v)) {}
+        LiteralExpr(LiteralType t, SymbolId v)
+            : type(t), value(v) {}
 
         void accept(ASTVisitor& visitor) override;
     };
@@ -50,12 +63,12 @@ namespace CustomLang {
     // Binary expression (aur, ya)
     class BinaryExpr : public Expression {
     public:
-        std::unique_ptr<Expression> left;
-        std::string op;
-        std::unique_ptr<Expression> right;
+        Expression* left;
+        BinaryOp op;
+        Expression* right;
 
-        BinaryExpr(std::unique_ptr<Expression> l, std::string o, std::unique_ptr<Expression> r)
-            : left(std::move(l)), op(std::move(o)), right(std::move(r)) {}
+        BinaryExpr(Expression* l, BinaryOp o, Expression* r)
+            : left(l), op(o), right(r) {}
 
         void accept(ASTVisitor& visitor) override;
     };
@@ -63,10 +76,10 @@ namespace CustomLang {
     // Print Statement
     class PrintStatement : public Statement {
     public:
-        std::unique_ptr<Expression> expression;
+        Expression* expression;
 
-        explicit PrintStatement(std::unique_ptr<Expression> expr)
-            : expression(std::move(expr)) {}
+        explicit PrintStatement(Expression* expr)
+            : expression(expr) {}
 
         void accept(ASTVisitor& visitor) override;
     };
@@ -75,17 +88,17 @@ namespace CustomLang {
     class FunctionDecl : public Statement {
     public:
         struct Param {
-            std::string name;
-            std::string type;
+            SymbolId name;
+            SymbolId type;      // Symbols::INT, Symbols::STRING, ...
         };
 
-        std::string name;
-        std::vector<Param> params;
-        std::vector<std::unique_ptr<Statement>> body;
-        std::unique_ptr<Expression> returnExpr;
+        SymbolId name;
+        std::pmr::vector<Param> params;
+        StatementList body;
+        Expression* returnExpr = nullptr;
 
-        FunctionDecl(std::string n, std::vector<Param> p, std::vector<std::unique_ptr<Statement>> b)
-        : name(std::move(n)), params(std::move(p)), body(std::move(b)) {}
+        FunctionDecl(SymbolId n, std::pmr::vector<Param> p, StatementList b)
+        : name(n), params(std::move(p)), body(std::move(b)) {}
 
     void accept(ASTVisitor& visitor) override;
     };
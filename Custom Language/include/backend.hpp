@@ -0,0 +1,27 @@
+// backend.hpp
+// Native code output: object files through the TargetMachine's codegen
+// passes, and executables by linking them against the prebuilt runtime
+// library (awara_runtime).
+#pragma once
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+#include <string>
+#include <vector>
+
+namespace CustomLang {
+
+    // Compiles `module` to a native object file at `path`. The module should
+    // already carry the target's triple and data layout (optimizeModule does
+    // that). Throws std::runtime_error on failure.
+    void emitObjectFile(llvm::Module& module, llvm::TargetMachine& target, const std::string& path);
+
+    // Links `objectPaths` with the runtime library into the executable
+    // `outputPath` using the system C++ driver ($CXX, else c++). Throws
+    // std::runtime_error if the driver is missing or the link fails.
+    void linkExecutable(const std::vector<std::string>& objectPaths, const std::string& outputPath);
+
+    // Where linkExecutable looks for the runtime archive ($AWARA_RUNTIME
+    // overrides the path baked in at build time)
+    std::string runtimeLibraryPath();
+
+} // namespace CustomLang
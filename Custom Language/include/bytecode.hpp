@@ -0,0 +1,84 @@
+// bytecode.hpp
+// Register bytecode for the interpreter (--interpret). Instructions are 32
+// bits: an 8-bit opcode, an 8-bit register A, then either two 8-bit
+// registers B and C or a 16-bit operand Bx. Each function has its own
+// constant table and register window.
+#pragma once
+#include "flat_ast.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CustomLang {
+
+    enum class OpCode : uint8_t {
+        LOADK,  // R[A] = K[Bx]
+        AND,    // R[A] = R[B] aur R[C]
+        OR,     // R[A] = R[B] ya R[C]
+        PRINT,  // dikha R[A]
+        CALL,   // call functions[Bx]
+        RET,    // return to the caller (or stop, from the entry function)
+        COUNT
+    };
+
+    struct Value {
+        enum class Kind : uint8_t { NUMBER, STRING, BOOLEAN, KHALI };
+
+        Kind kind;
+        union {
+            int32_t number;
+            bool boolean;
+            const char* string;     // NUL-terminated, on the GC heap
+        };
+    };
+
+    namespace bytecode {
+        inline uint32_t encode(OpCode op, uint8_t a, uint8_t b = 0, uint8_t c = 0) {
+            return static_cast<uint32_t>(op) | uint32_t(a) << 8 | uint32_t(b) << 16 | uint32_t(c) << 24;
+        }
+        inline uint32_t encodeBx(OpCode op, uint8_t a, uint16_t bx) {
+            return static_cast<uint32_t>(op) | uint32_t(a) << 8 | uint32_t(bx) << 16;
+        }
+
+        inline OpCode op(uint32_t instruction) { return static_cast<OpCode>(instruction & 0xFF); }
+        inline uint8_t a(uint32_t instruction) { return (instruction >> 8) & 0xFF; }
+        inline uint8_t b(uint32_t instruction) { return (instruction >> 16) & 0xFF; }
+        inline uint8_t c(uint32_t instruction) { return instruction >> 24; }
+        inline uint16_t bx(uint32_t instruction) { return instruction >> 16; }
+    }
+
+    struct BytecodeFunction {
+        static constexpr uint32_t NO_ROOT = ~uint32_t(0);
+
+        std::string name;
+        uint32_t codeOffset;        // into BytecodeProgram::code
+        uint32_t constantOffset;    // into BytecodeProgram::constants
+        uint32_t registerCount;
+        uint32_t root;              // position in FlatAST::roots, NO_ROOT for the entry
+    };
+
+    class BytecodeProgram {
+    public:
+        // functions[0] is the entry: the top-level statements, then the
+        // user's main if there is one
+        std::vector<BytecodeFunction> functions;
+        std::vector<uint32_t> code;
+        std::vector<Value> constants;
+
+        BytecodeProgram() = default;
+        BytecodeProgram(BytecodeProgram&&) = default;
+        BytecodeProgram& operator=(BytecodeProgram&&) = default;
+        ~BytecodeProgram();   // unroots the string constants
+
+        // Copies `text` to the GC heap as a rooted string constant
+        const char* internString(std::string_view text);
+
+    private:
+        std::vector<void*> heapStrings_;
+    };
+
+    // Compiles with the same static checks as CodeGenerator; throws
+    // std::runtime_error on errors
+    BytecodeProgram compileBytecode(const FlatAST& ast);
+
+} // namespace CustomLang
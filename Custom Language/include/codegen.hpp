@@ -1,10 +1,14 @@
 #pragma once
 #include "ast.hpp"
+#include "flat_ast.hpp"
+#include "thread_pool.hpp"
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
-#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace CustomLang {
     class CodeGenerator : public ASTVisitor {
@@ -13,7 +17,31 @@ namespace CustomLang {
         ~CodeGenerator() override;  // Added override since we inherit from ASTVisitor
 
         // Main code generation method
-        std::unique_ptr<llvm::Module> generateIR(const std::vector<std::unique_ptr<Statement>>& ast);
+        std::unique_ptr<llvm::Module> generateIR(const StatementList& ast);
+        std::unique_ptr<llvm::Module> generateIR(const FlatAST& ast);
+
+        // Shards top-level functions across `pool`, each shard in its own
+        // context, and hands the shards back as separate modules: the JIT
+        // takes them all, or each becomes an object file. The first module
+        // holds main(), which calls into the others by name.
+        //
+        // Every mode rejects a function name defined twice. Before sharding
+        // the second definition was quietly renamed and never called.
+        std::vector<llvm::orc::ThreadSafeModule> generateShards(const FlatAST& ast, ThreadPool& pool);
+
+        // Throws if two functions in `ast` share a name. Modes that generate
+        // functions into separate modules check this before they start.
+        static void checkFunctionNames(const FlatAST& ast);
+
+        // Building blocks for callers that assemble modules themselves (see
+        // compile_cache.hpp). generateTopLevel emits the top-level statements
+        // and main, calling the user's main by declaration; generateFunction
+        // emits the single function at ast.roots[root].
+        std::unique_ptr<llvm::Module> generateTopLevel(const FlatAST& ast);
+        std::unique_ptr<llvm::Module> generateFunction(const FlatAST& ast, size_t root);
+
+        // The context generated modules live in; take it to hand a module to the JIT
+        std::unique_ptr<llvm::LLVMContext> takeContext() { return std::move(context_); }
 
         // Visitor pattern implementation
         void visitLiteralExpr(LiteralExpr& expr) override;
@@ -31,7 +59,7 @@ namespace CustomLang {
         llvm::Value* lastValue_{nullptr};  // Added to store expression results
 
         // Symbol table for variables and functions
-        std::map<std::string, llvm::Value*> symbolTable_;
+        std::unordered_map<SymbolId, llvm::Value*> symbolTable_;
 
         // Current function being generated
         llvm::Function* currentFunction_{nullptr};  // Added initialization
@@ -39,11 +67,36 @@ namespace CustomLang {
         // Khali value constant
         llvm::Value* khaliValue_{nullptr};  // Added initialization
 
+        // Top-level statements of this shard go into their own function;
+        // the generated main() calls them in shard order
+        size_t shardIndex_{0};
+        llvm::Function* topLevel_{nullptr};
+
+        // Root slots emitGCRoot handed out, per function still being built
+        std::unordered_map<llvm::Function*, std::vector<llvm::AllocaInst*>> gcRoots_;
+
+        // Emitters shared by the visitor and the flat-AST walker
+        class FlatEmitter;
+        void generateRange(const FlatAST& ast, size_t firstRoot, size_t lastRoot);
+        llvm::Value* emitLiteral(LiteralExpr::LiteralType type, SymbolId symbol);
+        llvm::Value* emitBinary(BinaryOp op, llvm::Value* left, llvm::Value* right);
+        llvm::Function* emitFunctionStart(SymbolId name,
+                                          const FunctionDecl::Param* params, size_t paramCount);
+        void emitFunctionEnd();
+        void emitPrint(llvm::Value* value);
+        void enterTopLevel();
+        void finishTopLevel();
+        // shardHasTopLevel[i]: shard i emitted top-level statements, here or in
+        // a module of its own
+        void emitEntryPoint(const std::vector<bool>& shardHasTopLevel, bool hasUserMain);
+
         // Helper methods
-        llvm::Value* createStringConstant(const std::string& str);
+        llvm::Value* createStringConstant(llvm::StringRef str);
         void createPrintFunction();
         void createKhaliConstant();
-        void registerWithGC(llvm::Value* value);
+        llvm::AllocaInst* emitGCRoot(llvm::Value* value);
+        void emitGCFrame(llvm::Function* function);
+        void emitSafepoint();
 
         // Added helper to get the last generated value
         llvm::Value* getLastValue() { return lastValue_; }
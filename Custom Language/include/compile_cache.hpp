@@ -0,0 +1,60 @@
+// compile_cache.hpp
+// On-disk cache of optimized bitcode, one entry per top-level function, for
+// incremental builds. An entry is keyed on a hash of the function's tokens
+// and of everything else its code depends on (the compiler binary, the
+// runtime bitcode, the -O level and the target), so unchanged functions are
+// loaded instead of being generated and optimized again.
+#pragma once
+#include "codegen.hpp"
+#include "flat_ast.hpp"
+#include "optimizer.hpp"
+#include "thread_pool.hpp"
+#include "token_buffer.hpp"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace CustomLang {
+
+    class FunctionCache {
+    public:
+        // `directory` is created on the first store
+        explicit FunctionCache(std::string directory);
+
+        // nullptr on a miss, including an entry that isn't bitcode at all
+        std::unique_ptr<llvm::MemoryBuffer> load(uint64_t key);
+
+        // Written to a temporary file and renamed, so concurrent compilers
+        // never see a partial entry. Failures only cost a future miss.
+        void store(uint64_t key, llvm::StringRef bitcode);
+
+        const std::string& directory() const { return directory_; }
+        size_t hits() const { return hits_; }
+        size_t misses() const { return misses_; }
+
+        // An entry load() returned but that couldn't be read after all
+        void rejected() {
+            hits_--;
+            misses_++;
+        }
+
+    private:
+        std::string directory_;
+        std::atomic<size_t> hits_{0};
+        std::atomic<size_t> misses_{0};
+
+        std::string entryPath(uint64_t key) const;
+    };
+
+    // Builds the program's module in `codegen`'s context. Top-level
+    // statements and main are generated and optimized fresh; every function
+    // is loaded from `cache`, or generated, optimized and stored on the pool.
+    // The result is already optimized, so don't run optimizeModule on it.
+    std::unique_ptr<llvm::Module> generateCached(CodeGenerator& codegen, const FlatAST& ast, const TokenBuffer& tokens,
+                                                 FunctionCache& cache, OptLevel level, llvm::TargetMachine& target,
+                                                 ThreadPool& pool);
+
+} // namespace CustomLang
@@ -0,0 +1,101 @@
+// flat_ast.hpp
+// Index-based, data-oriented form of the AST. Nodes are rows in parallel
+// arrays (kind, payload, symbol, child range) and children are node indices in
+// one shared array, so passes walk contiguous memory and dispatch with a
+// switch instead of virtual calls. Built from the pointer AST by flatten().
+#pragma once
+#include "ast.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace CustomLang {
+
+    enum class NodeKind : uint8_t {
+        LITERAL,    // payload: LiteralExpr::LiteralType, symbol: value
+        BINARY,     // payload: BinaryOp, children: left, right
+        PRINT,      // children: expression
+        FUNCTION    // payload: index into functions, symbol: name, children: body
+    };
+
+    using NodeIndex = uint32_t;
+
+    struct FlatAST {
+        struct Function {
+            uint32_t firstParam;
+            uint32_t paramCount;
+            NodeIndex returnExpr;   // INVALID_NODE if none
+        };
+
+        static constexpr NodeIndex INVALID_NODE = ~NodeIndex(0);
+
+        // One entry per node
+        std::vector<NodeKind> kinds;
+        std::vector<uint32_t> payloads;
+        std::vector<SymbolId> symbols;      // INVALID_SYMBOL for nodes without one
+        std::vector<uint32_t> firstChild;   // index into children
+        std::vector<uint32_t> childCount;
+
+        std::vector<NodeIndex> children;
+        std::vector<Function> functions;
+        std::vector<FunctionDecl::Param> params;
+
+        // Top-level statements in source order
+        std::vector<NodeIndex> roots;
+
+        size_t size() const { return kinds.size(); }
+
+        NodeIndex child(NodeIndex node, uint32_t i) const { return children[firstChild[node] + i]; }
+
+        LiteralExpr::LiteralType literalType(NodeIndex node) const {
+            return static_cast<LiteralExpr::LiteralType>(payloads[node]);
+        }
+        BinaryOp binaryOp(NodeIndex node) const { return static_cast<BinaryOp>(payloads[node]); }
+        const Function& function(NodeIndex node) const { return functions[payloads[node]]; }
+    };
+
+    // Lower a pointer AST
+    FlatAST flatten(const StatementList& ast);
+
+    // Switch-dispatched traversal. Derive with CRTP and override the visitX
+    // methods you need; the defaults visit children in order.
+    template <typename Derived>
+    class FlatASTWalker {
+    public:
+        explicit FlatASTWalker(const FlatAST& ast) : ast_(ast) {}
+
+        void walk() {
+            for (NodeIndex root : ast_.roots) {
+                visit(root);
+            }
+        }
+
+        void visit(NodeIndex node) {
+            switch (ast_.kinds[node]) {
+            case NodeKind::LITERAL:  derived().visitLiteral(node); break;
+            case NodeKind::BINARY:   derived().visitBinary(node); break;
+            case NodeKind::PRINT:    derived().visitPrint(node); break;
+            case NodeKind::FUNCTION: derived().visitFunction(node); break;
+            }
+        }
+
+        void visitChildren(NodeIndex node) {
+            uint32_t begin = ast_.firstChild[node];
+            uint32_t end = begin + ast_.childCount[node];
+            for (uint32_t i = begin; i < end; ++i) {
+                visit(ast_.children[i]);
+            }
+        }
+
+        void visitLiteral(NodeIndex) {}
+        void visitBinary(NodeIndex node) { visitChildren(node); }
+        void visitPrint(NodeIndex node) { visitChildren(node); }
+        void visitFunction(NodeIndex node) { visitChildren(node); }
+
+    protected:
+        const FlatAST& ast_;
+
+    private:
+        Derived& derived() { return static_cast<Derived&>(*this); }
+    };
+
+} // namespace CustomLang
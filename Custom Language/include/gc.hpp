@@ -1,34 +1,220 @@
 #pragma once
-#include <unordered_map>
+#include "heap.hpp"
+#include "marker.hpp"
+#include "nursery.hpp"
+#include "runtime_abi.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
 #include <vector>
 
 namespace CustomLang {
 
+    // Mark-sweep over the segregated heap. With AWARA_GC_NURSERY=<KiB> set it
+    // runs generationally: small objects start in a copying nursery that is
+    // collected on its own whenever eden fills, and collect() is a full
+    // collection of both generations.
+    //
+    // Roots are the frames generated code links into its thread's shadow
+    // stack, plus value roots registered with addRoot. Value roots can't be
+    // rewritten, so young objects they name are pinned.
+    //
+    // Any number of threads may allocate. Each is a mutator with its own heap
+    // cache and eden buffer, attached on first use (allocation, roots or a
+    // write barrier) and detached when the thread exits. A collection stops
+    // the world: it raises awara_gc_safepoint_requested and waits until every
+    // other mutator is parked at a safepoint poll or inside a SafeRegion.
+    //
+    // Full collections mark in parallel on AWARA_GC_THREADS threads (default:
+    // one per hardware thread), the collecting thread included. Sweeping is
+    // left to the heap, which does it lazily and in the background once the
+    // world is running again.
+    //
+    // With AWARA_GC_PAUSE_MS=<ms> set, startCycle() marks incrementally
+    // against a snapshot taken at the start of the cycle: a short pause greys
+    // the roots, then allocating threads take turns marking in pauses of at
+    // most that budget, until one empties the grey set and ends the cycle.
+    // Meanwhile preWriteBarrier logs every reference about to be overwritten
+    // and new objects are allocated marked, so nothing live at the snapshot
+    // or allocated since can be missed. Only the runtime and C++ callers
+    // store into reference slots today; generated code has no such stores,
+    // so it never calls the barrier. collect() always finishes in one pause.
+    //
+    // Cycles start on their own, paced like Go's GOGC: once the old space has
+    // grown by AWARA_GC_PERCENT (default 100) percent of what the last cycle
+    // found reachable, or earlier to stay under the soft AWARA_GC_MEMORY_LIMIT
+    // (MiB). "off" leaves only the limit, or with no limit only explicit
+    // collections. A limit too tight to meet gets more headroom whenever
+    // collecting takes over half the time, and incremental cycles start
+    // early by what the last one allocated while it marked.
     class GarbageCollector {
     public:
-        struct ObjectHeader {
-            size_t size;
-            bool marked;
-            void* data;
+        struct Stats {
+            Heap::Stats heap;
+            size_t nurseryBytes = 0;        // eden size; 0 unless generational
+            size_t minorCollections = 0;
+            size_t fullCollections = 0;
+            size_t survivorBytes = 0;       // copied within the nursery
+            size_t promotedBytes = 0;       // copied into the old space
+            double minorSeconds = 0.0;
+            double fullSeconds = 0.0;
+            double markSeconds = 0.0;       // part of fullSeconds
+            unsigned markThreads = 0;       // 0 until the first full collection
+            size_t markSlices = 0;          // incremental pauses, not counting the first
+            size_t pacedCycles = 0;         // full cycles the pacer started
+            size_t markedBytes = 0;         // payload the last full cycle found reachable
+            size_t heapGoal = 0;            // old-space payload to collect by; SIZE_MAX: none
+        };
+
+        // Minor collections an object survives before it is promoted
+        static constexpr uint32_t PROMOTION_AGE = 2;
+
+        // Bytes a thread allocates during incremental marking between the
+        // slices it marks
+        static constexpr size_t MARK_ASSIST_BYTES = 256 * 1024;
+
+        // Smallest goal the pacer sets, so small heaps don't collect constantly
+        static constexpr size_t MIN_HEAP_GOAL = 4 * 1024 * 1024;
+
+        // While one is alive the calling thread promises not to touch the
+        // heap or its shadow stack, so collections don't wait for it. Wrap
+        // blocking calls (joins, I/O, locks) in one.
+        class SafeRegion {
+        public:
+            SafeRegion();
+            ~SafeRegion();
+            SafeRegion(const SafeRegion&) = delete;
+            SafeRegion& operator=(const SafeRegion&) = delete;
         };
 
         static GarbageCollector& getInstance();
         void* allocate(size_t size);
+        // The first `references` pointer slots of the payload are traced
+        void* allocate(size_t size, uint32_t references);
+        // Skips the nursery, for objects that will live long anyway
+        void* allocateOld(size_t size, uint32_t references = 0);
+        // Pointers that aren't heap objects are ignored when roots are scanned.
+        // Like allocation, both poll the safepoint (once the root is updated).
         void addRoot(void* ptr);
         void removeRoot(void* ptr);
         void collect();
+        // Begins an incremental cycle, unless one is running; without a pause
+        // budget, the same as collect()
+        void startCycle();
+        bool marking() const { return __atomic_load_n(&awara_gc_marking, __ATOMIC_RELAXED) != 0; }
+
+        // Override AWARA_GC_PERCENT (negative: off) and AWARA_GC_MEMORY_LIMIT
+        // (in bytes here; 0: none). Take effect at once.
+        void setGCPercent(int percent);
+        void setMemoryLimit(size_t bytes);
+
+        // Call before overwriting one of an object's reference slots, with
+        // the reference about to be lost. While a cycle is marking it is
+        // logged, so the snapshot stays intact.
+        void preWriteBarrier(void* previous) {
+            if (previous && marking()) {
+                shade(previous);
+            }
+        }
+        void shade(void* ptr);
+
+        // Call after storing value into one of object's reference slots.
+        // Old-to-young pointers are remembered so minor collections can
+        // treat them as roots and update them.
+        void writeBarrier(void* object, void* value) {
+            if (nursery && nursery->contains(value) && !nursery->contains(object)) {
+                remember(object);
+            }
+        }
+        // Attaches the thread but never polls: callers keep raw pointers
+        // across a barrier, and a minor collection between the store and
+        // the record would miss the pointer
+        void remember(void* object);
+
+        // Threads attach on their first allocation anyway; attaching up front
+        // just moves the cost. Detaching hands the thread's cached pages back.
+        void attachThread();
+        void detachThread();
+
+        // Parks the calling thread while a collection is pending
+        void safepoint();
+
+        // Head of the calling thread's shadow stack
+        awara_stack_entry** rootChain();
+
+        bool generational() const { return nursery != nullptr; }
+        Stats stats();
 
     private:
-        std::unordered_map<void*, ObjectHeader*> allocatedObjects;
-        std::vector<void*> roots;
+        struct Mutator;
+        class StoppedWorld;
+
+        static thread_local Mutator* current_;
+
+        Heap heap;
+        std::unique_ptr<Nursery> nursery;
+        std::unique_ptr<ParallelMarker> marker;    // started by the first full collection
+        unsigned markThreads = 0;
+        std::chrono::nanoseconds pauseBudget{0};    // 0: no incremental marking
+
+        // Pacing. Old-space growth since the last cycle ended is counted in
+        // allocatedSinceCycle; the rest is written with the world stopped.
+        int gcPercent = 100;                        // negative: off
+        size_t memoryLimit = 0;                     // 0: none
+        std::atomic<size_t> allocatedSinceCycle{0};
+        std::atomic<size_t> triggerBytes{0};        // growth that starts a cycle
+        std::atomic<size_t> goalBytes{0};           // growth that finishes one at once
+        size_t markStartAllocated = 0;              // allocatedSinceCycle when marking began
+        size_t markAllocated = 0;                   // allocated while the last cycle marked
+        double headroom = 0.0;                      // least growth allowed, as a fraction of live
+        double markSecondsAtCycleEnd = 0.0;
+        std::chrono::steady_clock::time_point lastCycleEnd;
+
+        // The collecting thread holds worldMutex throughout; it also guards
+        // the mutator list. Mutator::safe is guarded by parkMutex.
+        std::mutex worldMutex;
+        std::mutex parkMutex;
+        std::condition_variable parkChanged;
+        std::vector<Mutator*> mutators;
+        std::atomic<uint64_t> cycles{0};    // collections so far, minor ones included
 
-        void markPhase();
+        std::mutex rootsMutex;
+        std::unordered_set<void*> roots;
+        std::mutex rememberMutex;
+        std::vector<ObjectHeader*> rememberedSet;
+
+        // Used only with the world stopped
+        std::vector<ObjectHeader*> greyObjects;     // marked, references not yet scanned
+        std::vector<void*> orphanedLog;             // left behind by detached threads
+        std::vector<ObjectHeader*> markStack;       // minor collections' scan stack
+        std::vector<ObjectHeader*> pinnedObjects;
+        Heap::ThreadCache promotionCache;
+        Stats counters;
+
+        Mutator& mutator();
+        void enterSafe(Mutator& self);
+        void leaveSafe(Mutator& self);
+
+        void pace(Mutator& self);
+        void setGoal();
+        void updatePacing();
+
+        void beginMarking();
+        bool advanceMarking(std::chrono::steady_clock::time_point deadline);
+        void markSlice(Mutator& self);
         void markObject(void* ptr);
         void sweepPhase();
 
-        GarbageCollector() = default;
+        void collectNursery(bool promoteAll);
+        void evacuate(void*& slot, bool promoteAll);
+
+        GarbageCollector();
         ~GarbageCollector();
+        GarbageCollector(const GarbageCollector&) = delete;
+        GarbageCollector& operator=(const GarbageCollector&) = delete;
     };
 
 } // namespace CustomLang
\ No newline at end of file
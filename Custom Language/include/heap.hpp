@@ -0,0 +1,146 @@
+// heap.hpp
+// Size-class segregated heap behind the garbage collector. Small objects live
+// in 64 KiB aligned pages, each carved into equal cells of one size class and
+// handed out by bump pointer, then from a per-page free list that sweeping
+// refills. Allocation and mark state are side bitmaps in the page header, so
+// the allocation path never hashes and sweeping never reads dead objects.
+// Objects too big for the largest class get their own mmap.
+//
+// Sweeping happens after the pause. sweep() only queues the pages; an
+// allocation that needs a page sweeps one of its class on the spot, and a
+// background thread sweeps the rest, unmaps dead large objects and hands the
+// memory of surplus empty pages back to the OS with madvise(MADV_DONTNEED).
+//
+// Each mutator thread allocates through its own ThreadCache, which owns the
+// page it is filling in every class, so the fast path takes no lock. The
+// shared page pool, the large-object table and the statistics sit behind
+// one mutex.
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CustomLang {
+
+    // Precedes every payload. The first `references` pointer-sized payload
+    // slots hold heap references (or null); that's what the collector traces.
+    struct alignas(8) ObjectHeader {
+        static constexpr uint32_t MAX_REFERENCES = (1u << 24) - 1;
+
+        uint32_t size;              // payload bytes requested
+        uint32_t references : 24;
+        uint32_t age : 4;           // minor collections survived in the nursery
+        uint32_t forwarded : 1;     // evacuated; the first payload word is the new address
+        uint32_t pinned : 1;        // named by a value root during this minor collection
+        uint32_t remembered : 1;    // old object already in the remembered set
+        uint32_t : 1;
+
+        void* payload() { return this + 1; }
+        void** referenceSlots() { return reinterpret_cast<void**>(this + 1); }
+    };
+
+    class Heap {
+        struct Page;
+
+    public:
+        static constexpr size_t PAGE_SIZE = 64 * 1024;
+        static constexpr size_t GRANULE = 16;
+        static constexpr size_t MAX_CELL_SIZE = 2048;   // header included
+        static constexpr size_t CLASS_COUNT = 24;
+
+        struct Stats {
+            size_t pages = 0;               // small-object pages mapped, empty ones included
+            size_t releasedPages = 0;       // still mapped, but their memory given back to the OS
+            size_t largeObjects = 0;
+            size_t committedBytes = 0;      // resident pages plus large mappings
+            size_t liveBytes = 0;           // cells and mappings not yet swept
+            size_t allocatedBytes = 0;      // handed out since startup
+            size_t allocations = 0;
+        };
+
+        // Per-thread allocation state: the page being filled in each class
+        class ThreadCache {
+            friend class Heap;
+            Page* current[CLASS_COUNT] = {};
+            size_t allocatedBytes = 0;
+            size_t allocations = 0;
+        };
+
+        Heap() = default;
+        ~Heap();
+        Heap(const Heap&) = delete;
+        Heap& operator=(const Heap&) = delete;
+
+        // Payload of a new object (8-byte aligned) with its reference slots
+        // zeroed, or nullptr when the OS refuses more memory or references
+        // exceeds ObjectHeader::MAX_REFERENCES
+        void* allocate(ThreadCache& cache, size_t size, uint32_t references = 0);
+
+        // Returns the cache's pages to the shared pool and folds in its counters
+        void flush(ThreadCache& cache);
+
+        // Exact only with every mutator stopped and its cache flushed
+        Stats stats() const;
+
+        // The rest run with every mutator stopped.
+
+        // Header of the object whose payload starts at ptr, else nullptr.
+        // Until its page is swept, a dead object is still found.
+        ObjectHeader* find(const void* ptr) const;
+
+        // Marks the object at ptr. Returns its header the first time, nullptr
+        // if it was already marked or isn't a heap object. Marker threads may
+        // call it concurrently; exactly one of them wins each object. Every
+        // page must have been swept since the last mark (finishSweeping).
+        ObjectHeader* tryMark(const void* ptr);
+
+        // Whether the object at ptr survived the last mark. Valid until
+        // sweep() is called.
+        bool isMarked(const void* ptr) const;
+
+        // Starts freeing every unmarked object. Large objects are dropped at
+        // once; pages are queued for lazy and background sweeping, which
+        // clears their marks. Every ThreadCache must have been flushed.
+        void sweep();
+
+        // Sweeps whatever the background thread hasn't got to yet
+        void finishSweeping();
+
+        // While set, new objects come out already marked, so an incremental
+        // mark that started before they existed can't lose them
+        void setAllocateMarked(bool marked) { allocateMarked_ = marked; }
+
+    private:
+        struct FreeCell;
+        struct LargeObject;
+
+        mutable std::mutex mutex_;
+        std::vector<Page*> available_[CLASS_COUNT];     // pages with free cells, per class
+        std::vector<Page*> unswept_[CLASS_COUNT];       // lowest address last
+        std::vector<Page*> pages_;          // sorted by address
+        std::vector<Page*> emptyPages_;     // resident, for reuse by any class
+        std::vector<Page*> releasedPages_;  // empty and decommitted
+        std::map<uintptr_t, LargeObject*> largeObjects_;   // keyed by payload address
+        std::vector<LargeObject*> deadLargeObjects_;     // waiting to be unmapped
+        size_t allocatedBytes_ = 0;
+        size_t allocations_ = 0;
+        bool allocateMarked_ = false;       // written only with every mutator stopped
+
+        // The background sweeper; started by the first sweep
+        std::thread sweeper_;
+        std::condition_variable sweepWanted_;
+        bool sweepPending_ = false;
+        bool stopping_ = false;
+
+        Page* pageFor(const void* ptr) const;
+        Page* refill(ThreadCache& cache, size_t sizeClass);
+        void* allocateLarge(size_t size, uint32_t references);
+        void sweepPage(Page* page);
+        void sweeperLoop();
+    };
+
+} // namespace CustomLang
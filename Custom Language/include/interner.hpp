@@ -0,0 +1,69 @@
+// interner.hpp
+// Process-wide string interner. Every identifier and literal is mapped to a
+// stable 32-bit SymbolId when it is lexed; later stages compare and key
+// tables by ID and only look the text up when they need to emit it. Each
+// thread remembers the symbols it has interned, so lexers running in
+// parallel only meet on the shared lock for text new to them.
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+namespace CustomLang {
+
+    using SymbolId = uint32_t;
+
+    inline constexpr SymbolId INVALID_SYMBOL = ~SymbolId(0);
+
+    // Interned up front, in this order, so their IDs are constants
+    namespace Symbols {
+        inline constexpr SymbolId INT = 0;
+        inline constexpr SymbolId STRING = 1;
+        inline constexpr SymbolId FLOAT = 2;
+        inline constexpr SymbolId BOOL = 3;
+        inline constexpr SymbolId TRUE_ = 4;
+        inline constexpr SymbolId FALSE_ = 5;
+        inline constexpr SymbolId KHALI = 6;
+        inline constexpr SymbolId MAIN = 7;
+    }
+
+    class StringInterner {
+    public:
+        static StringInterner& getInstance();
+
+        // ID for `text`, adding it if it's new. Thread-safe; lock-free for
+        // text this thread has interned before.
+        SymbolId intern(std::string_view text);
+
+        // Text of an interned symbol. The view stays valid for the process lifetime.
+        std::string_view name(SymbolId id) const;
+
+        size_t size() const;
+        size_t bytesStored() const;
+
+    private:
+        StringInterner();
+
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        mutable std::shared_mutex mutex_;
+
+        std::vector<std::string_view> names_;       // by SymbolId
+        std::vector<size_t> hashes_;                // by SymbolId
+        std::vector<SymbolId> table_;               // open addressing, INVALID_SYMBOL = empty
+
+        // Character storage; blocks never move so views stay valid
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        std::vector<std::unique_ptr<char[]>> largeStrings_;
+        size_t blockUsed_ = BLOCK_SIZE;
+        size_t bytesStored_ = 0;
+
+        SymbolId find(std::string_view text, size_t hash) const;
+        SymbolId insert(std::string_view text, size_t hash);
+        std::string_view store(std::string_view text);
+        void grow();
+    };
+
+} // namespace CustomLang
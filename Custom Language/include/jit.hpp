@@ -0,0 +1,49 @@
+// jit.hpp
+// In-process execution with ORC LLJIT. The runtime's C entry points
+// (Runtime::symbols()) are bound as absolute symbols, so generated code
+// calls straight into this process.
+#pragma once
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm::orc {
+    class LLJIT;
+}
+
+namespace CustomLang {
+
+    // One JIT session. Throws std::runtime_error when LLVM reports an error.
+    // Adding modules and looking up symbols is safe from any thread.
+    class Jit {
+    public:
+        // With compileThreads, modules are compiled on that many threads of
+        // the session's own; lookups wait for what they need
+        explicit Jit(unsigned compileThreads = 0);
+        ~Jit();
+
+        // `module` must live in `context`; both are owned by the session after this
+        void addModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context);
+        void addModule(llvm::orc::ThreadSafeModule module);
+
+        // Address of a defined symbol. The first lookup generates its machine code.
+        void* lookup(const std::string& name);
+
+    private:
+        std::unique_ptr<llvm::orc::LLJIT> jit_;
+    };
+
+    struct JitResult {
+        int exitCode;
+        double compileSeconds;  // JIT setup + machine code generation for main
+        double executeSeconds;  // running main
+    };
+
+    // Compiles `modules` into one session and calls main(), which one of
+    // them must define. The rest may define anything it reaches.
+    JitResult runJit(std::vector<llvm::orc::ThreadSafeModule> modules, unsigned compileThreads = 0);
+
+} // namespace CustomLang
@@ -0,0 +1,74 @@
+// keywords.hpp
+// Keyword recognition through a perfect hash built at compile time. The table
+// is a constant, so lexers need no setup and a lookup is one hash and at most
+// one comparison against the source bytes.
+#pragma once
+#include "lexer.hpp"
+#include <cstddef>
+#include <string_view>
+
+namespace CustomLang {
+namespace keywords {
+
+    struct Keyword {
+        std::string_view spelling;
+        TokenType type = TokenType::IDENTIFIER;
+    };
+
+    inline constexpr Keyword all[] = {
+        { "dikha",     TokenType::DIKHA_BHAI },
+        { "bhai",      TokenType::DIKHA_BHAI },
+        { "dekh",      TokenType::DEKH },
+        { "wapas.kro", TokenType::WAPAS_KRO },
+        { "aur",       TokenType::AUR },
+        { "ya",        TokenType::YA },
+        { "khali",     TokenType::KHALI },
+        { "int",       TokenType::INT },
+        { "string",    TokenType::STRING },
+        { "float",     TokenType::FLOAT },
+        { "bool",      TokenType::BOOL },
+    };
+
+    inline constexpr size_t TABLE_SIZE = 16;
+
+    // Length plus first and last byte is enough to tell our keywords apart
+    constexpr size_t hash(const char* text, size_t length) {
+        return (length + 4 * (static_cast<unsigned char>(text[0]) +
+                              static_cast<unsigned char>(text[length - 1]))) & (TABLE_SIZE - 1);
+    }
+
+    struct Table {
+        Keyword slots[TABLE_SIZE] = {};
+        size_t minLength = ~size_t(0);
+        size_t maxLength = 0;
+
+        constexpr Table() {
+            for (const Keyword& keyword : all) {
+                Keyword& slot = slots[hash(keyword.spelling.data(), keyword.spelling.size())];
+                if (!slot.spelling.empty()) {
+                    // Reached only during constant evaluation: fails the build
+                    throw "keyword hash collision, pick a different hash";
+                }
+                slot = keyword;
+                if (keyword.spelling.size() < minLength) minLength = keyword.spelling.size();
+                if (keyword.spelling.size() > maxLength) maxLength = keyword.spelling.size();
+            }
+        }
+    };
+
+    inline constexpr Table table{};
+
+    // Keyword type for `text`, or IDENTIFIER if it isn't one
+    constexpr TokenType lookup(std::string_view text) {
+        if (text.size() < table.minLength || text.size() > table.maxLength) {
+            return TokenType::IDENTIFIER;
+        }
+        const Keyword& slot = table.slots[hash(text.data(), text.size())];
+        return slot.spelling == text ? slot.type : TokenType::IDENTIFIER;
+    }
+
+    static_assert(lookup("wapas.kro") == TokenType::WAPAS_KRO, "keyword table is broken");
+    static_assert(lookup("dikhao") == TokenType::IDENTIFIER, "keyword table is broken");
+
+} // namespace keywords
+} // namespace CustomLang
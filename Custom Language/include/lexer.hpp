@@ -1,8 +1,9 @@
 #pragma once
+#include "interner.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
-#include <unordered_map>
 
 namespace CustomLang {
 
@@ -44,55 +45,51 @@ namespace CustomLang {
 		INVALID
 	};
 
+	// Tokens don't own their text: `lexeme` is a view into the source buffer,
+	// so the source must outlive every token. Identifiers and literals are also
+	// interned at lex time; `symbol` is their ID (string literals are interned
+	// with escapes resolved) and the AST only keeps the ID.
 	class Token {
 	public:
 		TokenType type;
-		std::string lexeme;
+		std::string_view lexeme;
 		int line;
 		int column;
+		SymbolId symbol = INVALID_SYMBOL;
 
-		Token(TokenType t, std::string l, int ln, int col)
-			:type(t), lexeme(std::move(l)), line(ln), column(col) {}
+		Token(TokenType t, std::string_view l, int ln, int col)
+			:type(t), lexeme(l), line(ln), column(col) {}
 
 	};
 
+	// Resolves escape sequences in a string literal body into `out`. Only
+	// literals that contain a backslash go through this.
+	void unescapeString(std::string_view body, std::string& out);
+
 	class Lexer {
 	public:
-		explicit Lexer(std::string source) : source_(std::move(source)) {
-			initializedKeywords();
-		}
+		// The lexer works on the caller's buffer in place; it must outlive the lexer
+		explicit Lexer(std::string_view source) : source_(source) {}
 
 		Token nextToken();
 
+		std::string_view source() const { return source_; }
+
 	private:
-		std::string source_;
+		std::string_view source_;
 		size_t current_ = 0;
 		size_t start_ = 0;
 		int line_ = 1;
 		int column_ = 1;
-
-		std::unordered_map<std::string, TokenType> keywords_;
-
-		void initializedKeywords() {
-			keywords_["dikha"] = TokenType::DIKHA_BHAI;
-			keywords_["bhai"] = TokenType::DIKHA_BHAI;
-			keywords_["dekh"] = TokenType::DEKH;
-			keywords_["wapas.kro"] = TokenType::WAPAS_KRO;
-			keywords_["aur"] = TokenType::AUR;
-			keywords_["ya"] = TokenType::YA;
-			keywords_["khali"] = TokenType::KHALI;
-			keywords_["int"] = TokenType::INT;
-			keywords_["string"] = TokenType::STRING;
-			keywords_["float"] = TokenType::FLOAT;
-			keywords_["bool"] = TokenType::BOOL;
-
-		}
+		std::string scratch_;	// reused for unescaping string literals
 
 		char advance();
 		char peek() const;
 		char peekNext() const;
 		bool isAtEnd() const;
 		bool match(char expected);
+		void advanceTo(const char* pos);	// move within a line
+		void newlineAt(const char* pos);	// continue after the '\n' at pos
 
 		Token makeToken(TokenType type);
 		Token string();
@@ -0,0 +1,72 @@
+// marker.hpp
+// Parallel tracing for the collector's mark phase. Every marker thread owns a
+// work-stealing deque of grey objects: it pops from its own, marks children
+// with an atomic test-and-set on the heap's mark bits and pushes the ones it
+// won, and steals from the others when it runs dry. Marking ends when every
+// marker is idle with an empty deque, or, for an incremental slice, when its
+// deadline passes. The helpers are started once and sleep between rounds;
+// the collecting thread is always marker 0.
+#pragma once
+#include "heap.hpp"
+#include "work_stealing_deque.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CustomLang {
+
+    class ParallelMarker {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // threads counts the calling thread; 0 means one per hardware thread
+        ParallelMarker(Heap& heap, unsigned threads);
+        ~ParallelMarker();
+        ParallelMarker(const ParallelMarker&) = delete;
+        ParallelMarker& operator=(const ParallelMarker&) = delete;
+
+        unsigned threads() const { return static_cast<unsigned>(workers_.size()); }
+
+        // Traces everything reachable from grey, whose objects must already
+        // be marked (or live outside the heap, like pinned nursery objects).
+        // Runs with every mutator stopped. Returns true with grey empty once
+        // marking is complete; if the deadline comes first, returns false
+        // with the objects still to scan back in grey.
+        bool mark(std::vector<ObjectHeader*>& grey, Clock::time_point deadline = Clock::time_point::max());
+
+        // Payload bytes of the objects traced since the last call
+        size_t takeMarkedBytes();
+
+    private:
+        struct Worker {
+            WorkStealingDeque<ObjectHeader*> deque;
+            uint64_t seed;      // picks steal victims
+            size_t markedBytes = 0;
+        };
+
+        Heap& heap_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> helpers_;
+        std::atomic<unsigned> idle_{0};
+        std::atomic<bool> expired_{false};
+        Clock::time_point deadline_;
+
+        // Helpers wait here for the next round
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable finished_;
+        uint64_t round_ = 0;
+        unsigned running_ = 0;
+        bool stopping_ = false;
+
+        void helperLoop(unsigned index);
+        void trace(unsigned index);
+        bool steal(unsigned index, ObjectHeader*& header);
+        bool anyWork() const;
+    };
+
+} // namespace CustomLang
@@ -0,0 +1,99 @@
+// nursery.hpp
+// Young generation for the collector's generational mode: one reserved range
+// split into 64 KiB blocks. The mutator bump-allocates in eden blocks; a minor
+// collection copies what survives into survivor blocks (or the old space) and
+// recycles eden wholesale. A block holding a pinned object, i.e. one named by
+// a value root and so impossible to move, is kept as survivor space until the
+// next minor collection instead.
+//
+// Each mutator thread bump-allocates in an eden block of its own (a Buffer);
+// only taking the next block locks.
+#pragma once
+#include "heap.hpp"
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace CustomLang {
+
+    class Nursery {
+    public:
+        static constexpr size_t BLOCK_SIZE = Heap::PAGE_SIZE;
+        static constexpr size_t MAX_OBJECT_SIZE = 1024;    // payload; bigger objects start old
+
+        // A thread's eden block, or its survivor block during a collection
+        struct Buffer {
+            char* cursor = nullptr;
+            char* limit = nullptr;
+        };
+
+        // Reserves room for edenBytes of eden plus as much again for survivors
+        explicit Nursery(size_t edenBytes);
+        ~Nursery();
+        Nursery(const Nursery&) = delete;
+        Nursery& operator=(const Nursery&) = delete;
+
+        bool contains(const void* ptr) const {
+            return reinterpret_cast<uintptr_t>(ptr) - start() < reservedBytes_;
+        }
+        uintptr_t start() const { return reinterpret_cast<uintptr_t>(base_); }
+        uintptr_t end() const { return start() + reservedBytes_; }
+        size_t edenBytes() const { return edenBlocks_ * BLOCK_SIZE; }
+
+        // New object with zeroed reference slots, or nullptr once eden is full
+        void* allocate(Buffer& eden, size_t size, uint32_t references) {
+            size_t bytes = objectBytes(size);
+            if (static_cast<size_t>(eden.limit - eden.cursor) < bytes && !nextEdenBlock(eden)) {
+                return nullptr;
+            }
+
+            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(eden.cursor);
+            eden.cursor += bytes;
+            *header = ObjectHeader{};
+            header->size = static_cast<uint32_t>(size);
+            header->references = references;
+            std::memset(header->payload(), 0, references * sizeof(void*));
+            return header->payload();
+        }
+
+        // The rest run with every mutator stopped.
+
+        // Room for a copy made by a minor collection, or nullptr when the
+        // survivor blocks run out. Only the size is filled in.
+        ObjectHeader* allocateSurvivor(size_t size);
+
+        // Keeps the block holding ptr out of the next flip's recycling
+        void pin(const void* ptr);
+
+        // Ends a minor collection: eden and the previous survivor blocks are
+        // recycled, except pinned ones, which join the new survivor space.
+        // Every thread's Buffer must be reset as well.
+        void flip();
+
+        // Header plus payload, rounded to 8; payloads get at least one word so
+        // an evacuated object can hold its forwarding address
+        static size_t objectBytes(size_t size) {
+            return sizeof(ObjectHeader) + ((size < sizeof(void*) ? sizeof(void*) : size) + 7) / 8 * 8;
+        }
+
+    private:
+        char* base_{nullptr};
+        size_t reservedBytes_{0};
+        size_t edenBlocks_{0};
+
+        std::mutex mutex_;                      // eden block handout
+        std::vector<uint32_t> freeBlocks_;
+        std::vector<uint32_t> edenUsed_;
+        std::vector<uint32_t> fromSpace_;       // survivors of the last minor collection
+        std::vector<uint32_t> toSpace_;         // survivors of the running one
+        std::vector<uint8_t> pinned_;           // per block
+        Buffer survivor_;
+
+        bool nextEdenBlock(Buffer& eden);
+        bool takeBlock(std::vector<uint32_t>& space, Buffer& buffer);
+        uint32_t blockIndex(const void* ptr) const {
+            return static_cast<uint32_t>((reinterpret_cast<uintptr_t>(ptr) - start()) / BLOCK_SIZE);
+        }
+    };
+
+} // namespace CustomLang
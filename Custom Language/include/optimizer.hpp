@@ -0,0 +1,42 @@
+// optimizer.hpp
+// Runs LLVM's new-pass-manager default pipelines over a generated module,
+// tuned for the host through a TargetMachine.
+#pragma once
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace CustomLang {
+
+    enum class OptLevel { O0, O1, O2, O3, Os };
+
+    // "-O0" .. "-O3", "-Os"; nullopt for anything else
+    std::optional<OptLevel> parseOptLevel(std::string_view flag);
+
+    // TargetMachine for the host CPU and features. Throws std::runtime_error
+    // if LLVM has no backend for the host triple.
+    std::unique_ptr<llvm::TargetMachine> createHostTargetMachine(OptLevel level);
+
+    // The calling thread's own host TargetMachine for `level`, made on first
+    // use. Pass pipelines and codegen mutate target state, so threads working
+    // side by side mustn't share one.
+    llvm::TargetMachine& threadTargetMachine(OptLevel level);
+
+    // Links the runtime's entry points (runtime_abi.cpp, prebuilt as bitcode)
+    // into `module` and internalizes them so the optimizer can inline them.
+    // Returns false if no runtime bitcode was found; throws if it's unreadable.
+    bool linkRuntimeBitcode(llvm::Module& module);
+
+    // Where linkRuntimeBitcode looks ($AWARA_RUNTIME_BC overrides the path
+    // baked in at build time)
+    std::string runtimeBitcodePath();
+
+    // Stamps the target's triple and data layout on `module` and runs the
+    // default pipeline for `level`. With printTimings, per-pass times are
+    // reported on stderr.
+    void optimizeModule(llvm::Module& module, llvm::TargetMachine& target, OptLevel level, bool printTimings);
+
+} // namespace CustomLang
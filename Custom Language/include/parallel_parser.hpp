@@ -0,0 +1,25 @@
+// parallel_parser.hpp
+// Parses independent top-level declarations concurrently. The token array is
+// split at top-level 'dekh' tokens (outside any braces), each chunk is parsed
+// on the pool into its own arena, and the statements are stitched back in
+// source order.
+#pragma once
+#include "ast.hpp"
+#include "arena.hpp"
+#include "thread_pool.hpp"
+#include "token_buffer.hpp"
+#include <utility>
+#include <vector>
+
+namespace CustomLang {
+
+    // Token ranges [first, second) that can be parsed independently. Chunks
+    // hold at least `minTokens` tokens, except possibly the last one.
+    std::vector<std::pair<size_t, size_t>> splitTopLevel(const TokenBuffer& tokens, size_t minTokens);
+
+    // Same result and diagnostics as Parser(tokens, arena).parse(). Chunk
+    // arenas are adopted by `arena`. If any chunk fails, the whole input is
+    // re-parsed sequentially so errors are reported exactly as before.
+    StatementList parseParallel(const TokenBuffer& tokens, AstArena& arena, ThreadPool& pool);
+
+} // namespace CustomLang
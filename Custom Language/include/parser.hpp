@@ -1,23 +1,70 @@
 #pragma once
 #include "lexer.hpp"
+#include "token_buffer.hpp"
 #include "ast.hpp"
-#include <memory>
+#include "arena.hpp"
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
 #include <vector>
 
 namespace CustomLang {
     class Parser {
     public:
-        explicit Parser(Lexer lexer) 
+        // Nodes are allocated from `arena`, which must outlive the returned AST.
+
+        // Streaming mode: pull tokens from the lexer as parsing goes
+        Parser(Lexer lexer, AstArena& arena)
             : lexer_(std::move(lexer)), 
-              current_token_(TokenType::INVALID, "", 0, 0) {
+              source_(lexer_.source()),
+              arena_(arena),
+              streamed_(TokenType::INVALID, "", 0, 0) {
+            if (source_.size() > UINT32_MAX) {
+                throw std::runtime_error("Source file is too large for the parser (4 GiB max)");
+            }
             advance(); // Load first token
         }
 
-        std::vector<std::unique_ptr<Statement>> parse();
+        // Batched mode: walk a pre-lexed token array by index. Only tokens in
+        // [begin, end) are parsed; past `end` the parser sees EOF.
+        Parser(const TokenBuffer& tokens, AstArena& arena, size_t begin = 0, size_t end = SIZE_MAX)
+            : lexer_(std::string_view()),
+              tokens_(&tokens),
+              position_(begin),
+              end_(end < tokens.size() ? end : tokens.size()),
+              source_(tokens.source()),
+              arena_(arena),
+              streamed_(TokenType::INVALID, "", 0, 0) {
+            advance(); // Load first token
+        }
+
+        StatementList parse();
+
+        // Token n positions after the current one (peek(0) is the current token)
+        Token peek(size_t n);
+
+        // Errors are printed to stderr before being thrown unless this is off
+        void setReportErrors(bool report) { reportErrors_ = report; }
 
     private:
         Lexer lexer_;
-        Token current_token_;
+        const TokenBuffer* tokens_ = nullptr;   // set in batched mode
+        size_t position_ = 0;                   // next token index in batched mode
+        size_t end_ = 0;
+        bool reportErrors_ = true;
+        std::string_view source_;
+        std::deque<Token> lookahead_;           // streaming mode only
+        AstArena& arena_;
+
+        // The token being parsed. Batched mode points it straight into the
+        // buffer; streaming mode packs each lexed token into streamedPacked_.
+        const PackedToken* current_ = nullptr;
+        Token streamed_;                        // streaming mode only
+        PackedToken streamedPacked_;
+
+        TokenType currentType() const { return current_->kind(); }
+        std::string_view currentLexeme() const { return source_.substr(current_->offset, current_->length()); }
+        SymbolId currentSymbol() const { return current_->symbol; }
 
         void advance();
         bool match(TokenType type);
@@ -25,31 +72,39 @@ namespace CustomLang {
         Token consume(TokenType type, const std::string& message);
 
         // Parsing methods
-        std::unique_ptr<Statement> parseStatement();
-        std::unique_ptr<Statement> parsePrintStatement();
-        std::unique_ptr<Statement> parseFunctionDeclaration();
-        std::unique_ptr<Expression> parseExpression();
-        std::unique_ptr<Expression> parseBinaryExpression(int precedence = 0);
+        Statement* parseStatement();
+        Statement* parsePrintStatement();
+        Statement* parseFunctionDeclaration();
+        Expression* parseExpression();
+        Expression* parseBinaryExpression(int precedence = 0);
         
         // Helper methods for parsing expressions
-        std::unique_ptr<Expression> parsePrimary();
-        std::unique_ptr<Expression> parseLiteral();
-        std::unique_ptr<Expression> parseGrouping();
+        Expression* parsePrimary();
+        Expression* parseLiteral();
+        Expression* parseGrouping();
         
         // Error handling
         void logError(const std::string& baseMessage, 
                      const std::string& context, 
                      const std::string& suggestion = "");
-        void expect(TokenType type, const std::string& errorMessage);
+        // The message is only built when the token doesn't match
+        template <typename MessageBuilder>
+        void expect(TokenType type, MessageBuilder buildMessage) {
+            if (!match(type)) {
+                expectFailed(buildMessage());
+            }
+        }
+        void expectFailed(const std::string& errorMessage);
         void synchronize(); // Error recovery
-        std::unique_ptr<Expression> error(const std::string& message);
-        std::unique_ptr<Statement> errorStmt(const std::string& message);
+        Expression* error(const std::string& message);
+        Statement* errorStmt(const std::string& message);
         
         // Helper methods
         int getPrecedence(TokenType type) const;
         
         // Function parsing helpers
         std::vector<std::pair<std::string, TokenType>> parseParameters();
-        std::vector<std::unique_ptr<Statement>> parseBlock();
+        SymbolId parseTypeName();
+        StatementList parseBlock();
     };
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 #include "gc.hpp"
+#include "runtime_abi.hpp"
 
 namespace CustomLang {
 
@@ -17,14 +21,30 @@ namespace CustomLang {
 
         // Memory management functions
         static void* allocateMemory(size_t size);
+        static void* allocateLongLived(size_t size);    // skips the nursery
         static void freeMemory(void* ptr);
         static void markRoot(void* ptr);
         static void collectGarbage();
+        // Pacing, as AWARA_GC_PERCENT and AWARA_GC_MEMORY_LIMIT set it
+        static void setGCPercent(int percent);          // negative: off
+        static void setMemoryLimit(size_t bytes);       // 0: none
         static bool isKhali(void* ptr);
         static void* createKhali();
 
+        // Threads. One that allocates or runs generated code is registered
+        // on first use anyway and unregistered when it exits; registering
+        // up front moves that cost out of the hot path. A thread about to
+        // block (join, wait, I/O) holds a BlockingRegion so collections
+        // started meanwhile don't wait for it.
+        static void registerThread();
+        static void unregisterThread();
+        using BlockingRegion = GarbageCollector::SafeRegion;
+
         // Error handling
         static void handleError(const std::string& message);
+
+        // C symbols generated code may call (runtime_abi.hpp), by name
+        static std::vector<std::pair<const char*, void*>> symbols();
     };
 
 } // namespace CustomLang
\ No newline at end of file
@@ -0,0 +1,63 @@
+// runtime_abi.hpp
+// C ABI between generated code and the runtime. The entry points are small
+// fast paths (runtime_abi.cpp) that are also built as LLVM bitcode and linked
+// into optimized user modules, where they inline; they fall back to the
+// awara_rt_* slow paths, which live only in the runtime library.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+
+    // Entry points called from generated code
+    void dikha_bhai(const char* message);   // strings and khali (null)
+    void dikha_number(int32_t value);
+    void GC_register(void* ptr);
+    void* GC_allocate(size_t size);
+    void GC_collect();
+    void GC_safepoint();
+    struct awara_stack_entry** GC_root_chain();         // this thread's shadow stack head
+
+    // Write barriers for native code that stores into reference slots. The
+    // language has no such stores yet, so generated code never calls these.
+    void GC_pre_write_barrier(void* previous);          // before overwriting a reference
+    void GC_write_barrier(void* object, void* value);   // after storing value into object
+
+    // Slow paths (runtime.cpp)
+    void awara_rt_write_line(const char* data, size_t length);
+    void awara_rt_add_root(void* ptr);
+    void* awara_rt_allocate(size_t size);
+    void awara_rt_collect();
+    void awara_rt_remember(void* object);
+    void awara_rt_shade(void* object);
+    void awara_rt_safepoint();
+    struct awara_stack_entry** awara_rt_root_chain();
+
+    // Nursery address range, set by the collector (gc.cpp); both stay 0 unless
+    // it runs generationally
+    extern uintptr_t awara_gc_nursery_start;
+    extern uintptr_t awara_gc_nursery_end;
+
+    // Nonzero while a collection waits for threads to reach a safepoint (gc.cpp)
+    extern uint32_t awara_gc_safepoint_requested;
+
+    // Nonzero while an incremental cycle is marking (gc.cpp)
+    extern uint32_t awara_gc_marking;
+
+    // Shadow-stack frames, laid out as LLVM's shadow-stack GC strategy lays
+    // them out. A generated function with root slots links an entry into its
+    // thread's chain (GC_root_chain) on entry and unlinks it on return; the
+    // collector walks every thread's chain and updates the slots in place.
+    struct awara_frame_map {
+        int32_t numRoots;
+        int32_t numMeta;        // always 0
+        const void* meta[];
+    };
+
+    struct awara_stack_entry {
+        awara_stack_entry* next;
+        const awara_frame_map* map;
+        void* roots[];
+    };
+
+}
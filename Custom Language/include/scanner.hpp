@@ -0,0 +1,66 @@
+// scanner.hpp
+// Bulk byte scanners used by the lexer's hot loops. Each function classifies
+// 16 (SSE2) or 32 (AVX2) bytes per step; the implementation is picked once at
+// runtime from what the CPU supports, with a table-driven scalar fallback.
+#pragma once
+#include <cstdint>
+
+namespace CustomLang {
+namespace scan {
+
+    enum CharClass : uint8_t {
+        CC_SPACE       = 1 << 0,   // ' ', '\t', '\r', '\n'
+        CC_DIGIT       = 1 << 1,   // 0-9
+        CC_IDENT_START = 1 << 2,   // A-Z, a-z, _
+        CC_IDENT       = 1 << 3,   // identifier body: A-Z, a-z, 0-9, _, .
+        CC_STRING_STOP = 1 << 4    // '"', '\\', '\n'
+    };
+
+    struct CharTable {
+        uint8_t classes[256] = {};
+
+        constexpr CharTable() {
+            classes[static_cast<uint8_t>(' ')] |= CC_SPACE;
+            classes[static_cast<uint8_t>('\t')] |= CC_SPACE;
+            classes[static_cast<uint8_t>('\r')] |= CC_SPACE;
+            classes[static_cast<uint8_t>('\n')] |= CC_SPACE | CC_STRING_STOP;
+            classes[static_cast<uint8_t>('"')] |= CC_STRING_STOP;
+            classes[static_cast<uint8_t>('\\')] |= CC_STRING_STOP;
+            for (int c = '0'; c <= '9'; ++c) classes[c] |= CC_DIGIT | CC_IDENT;
+            for (int c = 'a'; c <= 'z'; ++c) classes[c] |= CC_IDENT_START | CC_IDENT;
+            for (int c = 'A'; c <= 'Z'; ++c) classes[c] |= CC_IDENT_START | CC_IDENT;
+            classes[static_cast<uint8_t>('_')] |= CC_IDENT_START | CC_IDENT;
+            classes[static_cast<uint8_t>('.')] |= CC_IDENT;
+        }
+    };
+
+    inline constexpr CharTable charTable{};
+
+    // Locale-free replacements for isalpha/isdigit on source bytes
+    inline bool is(char c, uint8_t cls) {
+        return (charTable.classes[static_cast<uint8_t>(c)] & cls) != 0;
+    }
+
+    struct WhitespaceRun {
+        const char* end;            // first non-whitespace byte (or the buffer end)
+        int newlines;               // '\n' bytes skipped
+        const char* lastNewline;    // last '\n' skipped, nullptr if none
+    };
+
+    // Skip ' ', '\t', '\r' and '\n' starting at p
+    WhitespaceRun skipWhitespace(const char* p, const char* end);
+
+    // First byte at or after p that can't continue an identifier
+    const char* skipIdentifier(const char* p, const char* end);
+
+    // First byte at or after p that isn't a decimal digit
+    const char* skipDigits(const char* p, const char* end);
+
+    // First '"', '\\' or '\n' at or after p, or end
+    const char* findStringStop(const char* p, const char* end);
+
+    // Name of the implementation selected for this CPU ("avx2", "sse2" or "scalar")
+    const char* implementationName();
+
+} // namespace scan
+} // namespace CustomLang
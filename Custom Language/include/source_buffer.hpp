@@ -0,0 +1,40 @@
+// source_buffer.hpp
+// Read-only view of a source file that the lexer can work on in place.
+// Regular files are memory-mapped; pipes, terminals and stdin ("-") are read
+// in chunks into a single growing heap block. Either way the program text
+// exists exactly once in memory.
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace CustomLang {
+
+    class SourceBuffer {
+    public:
+        SourceBuffer() = default;
+        ~SourceBuffer();
+
+        SourceBuffer(SourceBuffer&& other) noexcept;
+        SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+        SourceBuffer(const SourceBuffer&) = delete;
+        SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+        // Throws std::runtime_error if the file can't be opened or read
+        static SourceBuffer open(const std::string& path);
+
+        std::string_view view() const { return std::string_view(data_, size_); }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        bool isMapped() const { return mapped_; }
+
+    private:
+        char* data_ = nullptr;
+        size_t size_ = 0;
+        bool mapped_ = false;   // data_ came from mmap rather than malloc
+
+        static SourceBuffer readStream(int fd);
+        void release();
+    };
+
+} // namespace CustomLang
@@ -0,0 +1,75 @@
+// thread_pool.hpp
+// Fixed-size worker pool shared by the parallel compiler stages.
+#pragma once
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace CustomLang {
+
+    class ThreadPool {
+    public:
+        // 0 means one worker per hardware thread
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+        // Run `task` on a worker; exceptions are delivered through the future
+        template <typename Task>
+        std::future<std::invoke_result_t<Task>> submit(Task task) {
+            using Result = std::invoke_result_t<Task>;
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+            std::future<Result> result = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.emplace([packaged] { (*packaged)(); });
+            }
+            wake_.notify_one();
+            return result;
+        }
+
+        // Runs task(i) for every i in [0, count) and waits for all of them.
+        // If any throw, the exception from the lowest i is rethrown.
+        template <typename Task>
+        void forEach(size_t count, Task task) {
+            std::vector<std::future<void>> pending;
+            pending.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                pending.push_back(submit([&task, i] { task(i); }));
+            }
+
+            std::exception_ptr firstError;
+            for (auto& future : pending) {
+                try {
+                    future.get();
+                } catch (...) {
+                    if (!firstError) firstError = std::current_exception();
+                }
+            }
+            if (firstError) {
+                std::rethrow_exception(firstError);
+            }
+        }
+
+    private:
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> queue_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_ = false;
+
+        void workerLoop();
+    };
+
+} // namespace CustomLang
@@ -0,0 +1,67 @@
+// tiering.hpp
+// Tiered execution for --interpret. Functions start in the bytecode VM
+// (tier 0), which counts their calls; once a function reaches the threshold
+// it is compiled with LLVM at -O2 on a background thread and its native
+// entry is published atomically, so the VM's next call runs machine code.
+#pragma once
+#include "bytecode.hpp"
+#include "flat_ast.hpp"
+#include "jit.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace CustomLang {
+
+    class TierManager {
+    public:
+        using NativeFunction = void (*)();
+
+        // `ast` and `program` must outlive the manager. A threshold of 1
+        // compiles a function on its first call.
+        TierManager(const FlatAST& ast, const BytecodeProgram& program, uint32_t threshold, bool log);
+
+        // Cancels queued compiles and waits for the one in flight, if any
+        ~TierManager();
+
+        // Counts a call to program.functions[index]; returns its native entry
+        // once it has tiered up, nullptr while it's still interpreted
+        NativeFunction enter(size_t index) {
+            FunctionState& state = functions_[index];
+            if (NativeFunction native = state.native.load(std::memory_order_acquire)) {
+                return native;
+            }
+            if (state.calls.fetch_add(1, std::memory_order_relaxed) + 1 == threshold_) {
+                requestCompile(index);
+            }
+            return nullptr;
+        }
+
+    private:
+        struct FunctionState {
+            std::atomic<uint32_t> calls{0};
+            std::atomic<NativeFunction> native{nullptr};
+        };
+
+        const FlatAST& ast_;
+        const BytecodeProgram& program_;
+        uint32_t threshold_;
+        bool log_;
+        std::unique_ptr<FunctionState[]> functions_;
+
+        // Set by the destructor; compile() gives up when it sees it, since
+        // nothing will call the native code once the program has finished
+        std::atomic<bool> cancelled_{false};
+
+        // Created by the first compile, on the compiler thread
+        std::unique_ptr<Jit> jit_;
+
+        // Declared last so it drains before the JIT goes away
+        ThreadPool compiler_{1};
+
+        void requestCompile(size_t index);
+        void compile(size_t index);
+    };
+
+} // namespace CustomLang
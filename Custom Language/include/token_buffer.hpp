@@ -0,0 +1,55 @@
+// token_buffer.hpp
+// Whole-file token array for the batched parsing mode. The lexer runs once
+// over the source and every token is packed into 12 bytes; the parser then
+// walks the array by index and reads the packed fields in place, which gives
+// it O(1) lookahead. Line and column aren't stored per token: they are found
+// from the token's offset in a table of line starts, and only diagnostics
+// ask for them.
+#pragma once
+#include "lexer.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace CustomLang {
+
+    struct PackedToken {
+        uint32_t offset;        // byte offset of the lexeme in the source
+        uint32_t lengthKind;    // length << 8 | TokenType
+        SymbolId symbol;
+
+        TokenType kind() const { return static_cast<TokenType>(lengthKind & 0xFF); }
+        uint32_t length() const { return lengthKind >> 8; }
+
+        // `token` must come from lexing `source`, which is at most 4 GiB
+        static PackedToken pack(const Token& token, std::string_view source);
+    };
+
+    static_assert(sizeof(PackedToken) == 12, "PackedToken should stay at 12 bytes");
+
+    class TokenBuffer {
+    public:
+        // Lex all of `source` (which must outlive the buffer), up to and including EOF
+        static TokenBuffer lex(std::string_view source);
+
+        size_t size() const { return tokens_.size(); }
+        TokenType kind(size_t index) const { return tokens_[index].kind(); }
+        const PackedToken& packed(size_t index) const { return tokens_[index]; }
+        std::string_view source() const { return source_; }
+        std::string_view lexeme(const PackedToken& token) const {
+            return source_.substr(token.offset, token.length());
+        }
+
+        // Rebuild a full Token; indexes past the end give the EOF token
+        Token token(size_t index) const;
+
+        // Line and column the lexer gave the token, in O(log lines)
+        void position(const PackedToken& token, int& line, int& column) const;
+
+    private:
+        std::string_view source_;
+        std::vector<PackedToken> tokens_;
+        std::vector<uint32_t> lineStarts_;      // offset of each line's first byte
+    };
+
+} // namespace CustomLang
@@ -0,0 +1,34 @@
+// vm.hpp
+// Interpreter for BytecodeProgram. Dispatch is threaded (computed goto) on
+// GCC/Clang and a switch elsewhere. Output goes through Runtime::print.
+#pragma once
+#include "bytecode.hpp"
+#include <string>
+
+namespace CustomLang {
+
+    class TierManager;
+
+    class VM {
+    public:
+        VM();
+
+        // Count calls in `tiers` and call native code once a function has
+        // tiered up (see tiering.hpp); nullptr interprets everything
+        void setTiering(TierManager* tiers) { tiers_ = tiers; }
+
+        // Runs functions[0] to completion
+        void run(const BytecodeProgram& program);
+
+    private:
+        std::vector<Value> registers_;
+        TierManager* tiers_ = nullptr;
+
+        // Text for printed booleans, from the interner like codegen's
+        std::string trueText_;
+        std::string falseText_;
+
+        void print(const Value& value);
+    };
+
+} // namespace CustomLang
@@ -0,0 +1,126 @@
+// work_stealing_deque.hpp
+// Chase-Lev work-stealing deque (the C11 formulation of Le et al., "Correct
+// and Efficient Work-Stealing for Weak Memory Models"). The owning thread
+// pushes and pops at the bottom without contention; other threads steal from
+// the top, and only a race for the last item costs a compare-and-swap. The
+// ring grows on demand; outgrown rings are kept until reset() because a
+// stealer may still be reading one.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace CustomLang {
+
+    template <typename T>
+    class WorkStealingDeque {
+        static_assert(std::is_trivially_copyable<T>::value, "items are copied through atomics");
+
+    public:
+        explicit WorkStealingDeque(size_t capacity = 1024) {
+            size_t rounded = 1;
+            while (rounded < capacity) rounded <<= 1;
+            rings_.push_back(std::make_unique<Ring>(rounded));
+            ring_.store(rings_.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // Owner only
+        void push(T item) {
+            int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            int64_t top = top_.load(std::memory_order_acquire);
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+            if (bottom - top >= ring->capacity()) {
+                ring = grow(ring, top, bottom);
+            }
+            ring->put(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // Owner only. False once the deque is empty.
+        bool pop(T& item) {
+            int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            Ring* ring = ring_.load(std::memory_order_relaxed);
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = top_.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return false;
+            }
+            item = ring->get(bottom);
+            if (top == bottom) {
+                // Last item: settle it with any stealer through top
+                bool won = top_.compare_exchange_strong(top, top + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        // Any thread. False if the deque looked empty or another thread won
+        // the item.
+        bool steal(T& item) {
+            int64_t top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = bottom_.load(std::memory_order_acquire);
+            if (top >= bottom) return false;
+
+            Ring* ring = ring_.load(std::memory_order_acquire);
+            item = ring->get(top);
+            return top_.compare_exchange_strong(top, top + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        // Any thread; only a hint while the owner is pushing or popping
+        bool empty() const {
+            return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+        }
+
+        // Owner only, with no stealers around: frees outgrown rings
+        void reset() {
+            rings_.erase(rings_.begin(), rings_.end() - 1);
+            top_.store(0, std::memory_order_relaxed);
+            bottom_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        class Ring {
+        public:
+            explicit Ring(size_t capacity)
+                : mask_(static_cast<int64_t>(capacity) - 1), slots_(new std::atomic<T>[capacity]) {}
+
+            int64_t capacity() const { return mask_ + 1; }
+            T get(int64_t index) const { return slots_[index & mask_].load(std::memory_order_relaxed); }
+            void put(int64_t index, T item) { slots_[index & mask_].store(item, std::memory_order_relaxed); }
+
+        private:
+            int64_t mask_;
+            std::unique_ptr<std::atomic<T>[]> slots_;
+        };
+
+        // Separate cache lines: stealers hammer top_, the owner bottom_
+        alignas(64) std::atomic<int64_t> top_{0};
+        alignas(64) std::atomic<int64_t> bottom_{0};
+        alignas(64) std::atomic<Ring*> ring_{nullptr};
+        std::vector<std::unique_ptr<Ring>> rings_;      // owner only; the live ring is the last
+
+        Ring* grow(Ring* ring, int64_t top, int64_t bottom) {
+            rings_.push_back(std::make_unique<Ring>(static_cast<size_t>(ring->capacity()) * 2));
+            Ring* bigger = rings_.back().get();
+            for (int64_t i = top; i < bottom; ++i) {
+                bigger->put(i, ring->get(i));
+            }
+            ring_.store(bigger, std::memory_order_release);
+            return bigger;
+        }
+    };
+
+} // namespace CustomLang
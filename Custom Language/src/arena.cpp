@@ -0,0 +1,78 @@
+#include "arena.hpp"
+
+namespace CustomLang {
+
+    AstArena::AstArena(size_t initialBlockSize)
+        : upstream_(bytesReserved_),
+          buffer_(initialBlockSize, &upstream_) {}
+
+    void AstArena::release() {
+        children_.clear();
+        buffer_.release();
+        nodeCount_ = 0;
+        bytesUsed_ = 0;
+    }
+
+    void AstArena::adopt(std::unique_ptr<AstArena> child) {
+        children_.push_back(std::move(child));
+    }
+
+    size_t AstArena::nodeCount() const {
+        size_t total = nodeCount_;
+        for (const auto& child : children_) total += child->nodeCount();
+        return total;
+    }
+
+    size_t AstArena::bytesUsed() const {
+        size_t total = bytesUsed_;
+        for (const auto& child : children_) total += child->bytesUsed();
+        return total;
+    }
+
+    size_t AstArena::bytesReserved() const {
+        size_t total = bytesReserved_;
+        for (const auto& child : children_) total += child->bytesReserved();
+        return total;
+    }
+
+    double AstArena::allocationSeconds() const {
+        double total = std::chrono::duration<double>(allocationTime_).count();
+        for (const auto& child : children_) total += child->allocationSeconds();
+        return total;
+    }
+
+    void* AstArena::do_allocate(size_t bytes, size_t alignment) {
+        bytesUsed_ += bytes;
+        if (!timed_) {
+            return buffer_.allocate(bytes, alignment);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        void* memory = buffer_.allocate(bytes, alignment);
+        allocationTime_ += std::chrono::steady_clock::now() - start;
+        return memory;
+    }
+
+    void AstArena::do_deallocate(void*, size_t, size_t) {
+        // Individual frees are ignored; release() drops everything
+    }
+
+    bool AstArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    void* AstArena::UpstreamResource::do_allocate(size_t bytes, size_t alignment) {
+        reserved_ += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void AstArena::UpstreamResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+        reserved_ -= bytes;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool AstArena::UpstreamResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+} // namespace CustomLang
@@ -0,0 +1,64 @@
+#include "backend.hpp"
+#include <cstdlib>
+#include <stdexcept>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+
+// Set by CMake to the built awara_runtime archive
+#ifndef AWARA_RUNTIME_LIBRARY
+#define AWARA_RUNTIME_LIBRARY "libawara_runtime.a"
+#endif
+
+namespace CustomLang {
+
+    void emitObjectFile(llvm::Module& module, llvm::TargetMachine& target, const std::string& path) {
+        std::error_code ec;
+        llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_None);
+        if (ec) {
+            throw std::runtime_error("Object file nahi khula " + path + ": " + ec.message());
+        }
+
+        // The codegen pipeline still runs on the legacy pass manager
+        llvm::legacy::PassManager passes;
+        if (target.addPassesToEmitFile(passes, out, nullptr, llvm::CodeGenFileType::ObjectFile)) {
+            throw std::runtime_error("Ye target object files nahi bana sakta");
+        }
+        passes.run(module);
+        out.flush();
+    }
+
+    std::string runtimeLibraryPath() {
+        if (const char* path = std::getenv("AWARA_RUNTIME")) {
+            return path;
+        }
+        return AWARA_RUNTIME_LIBRARY;
+    }
+
+    void linkExecutable(const std::vector<std::string>& objectPaths, const std::string& outputPath) {
+        // The runtime is C++ and multi-threaded, so let the C++ driver pull
+        // in its libraries, pthreads included
+        const char* driverName = std::getenv("CXX");
+        llvm::ErrorOr<std::string> driver = llvm::sys::findProgramByName(driverName ? driverName : "c++");
+        if (!driver) {
+            throw std::runtime_error(std::string("Linker nahi mila (") + (driverName ? driverName : "c++") +
+                                     "): " + driver.getError().message());
+        }
+
+        std::string runtime = runtimeLibraryPath();
+        llvm::SmallVector<llvm::StringRef, 16> args = { *driver };
+        args.append(objectPaths.begin(), objectPaths.end());
+        args.append({ runtime, "-pthread", "-o", outputPath });
+
+        std::string error;
+        int status = llvm::sys::ExecuteAndWait(*driver, args, std::nullopt, {}, 0, 0, &error);
+        if (status != 0) {
+            throw std::runtime_error("Link fail ho gaya (" + *driver + " exit " + std::to_string(status) + ")" +
+                                     (error.empty() ? "" : ": " + error));
+        }
+    }
+
+} // namespace CustomLang
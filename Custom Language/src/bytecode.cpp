@@ -0,0 +1,233 @@
+#include "bytecode.hpp"
+#include "runtime.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace CustomLang {
+
+    BytecodeProgram::~BytecodeProgram() {
+        for (void* string : heapStrings_) {
+            Runtime::freeMemory(string);
+        }
+    }
+
+    const char* BytecodeProgram::internString(std::string_view text) {
+        // Constants live as long as the program; keep them out of the nursery
+        char* copy = static_cast<char*>(Runtime::allocateLongLived(text.size() + 1));
+        std::memcpy(copy, text.data(), text.size());
+        copy[text.size()] = '\0';
+        Runtime::markRoot(copy);
+        heapStrings_.push_back(copy);
+        return copy;
+    }
+
+    namespace {
+
+        class BytecodeCompiler : public FlatASTWalker<BytecodeCompiler> {
+        public:
+            BytecodeCompiler(const FlatAST& ast, BytecodeProgram& program)
+                : FlatASTWalker(ast), program_(program) {}
+
+            void compile() {
+                // Slot 0 is the entry; it's compiled last, once main has an index
+                program_.functions.emplace_back();
+
+                std::vector<NodeIndex> topLevel;
+                for (size_t i = 0; i < ast_.roots.size(); ++i) {
+                    NodeIndex root = ast_.roots[i];
+                    if (ast_.kinds[root] == NodeKind::FUNCTION) {
+                        currentRoot_ = static_cast<uint32_t>(i);
+                        visit(root);
+                    } else {
+                        topLevel.push_back(root);
+                    }
+                }
+                currentRoot_ = BytecodeFunction::NO_ROOT;
+
+                beginFunction("<top level>", true);
+                for (NodeIndex root : topLevel) {
+                    visit(root);
+                    nextRegister_ = 0;
+                }
+                if (userMain_ != NO_FUNCTION) {
+                    emit(bytecode::encodeBx(OpCode::CALL, 0, static_cast<uint16_t>(userMain_)));
+                }
+                endFunction();
+            }
+
+            void visitLiteral(NodeIndex node) {
+                Value value;
+                SymbolId symbol = ast_.symbols[node];
+                std::string_view text = StringInterner::getInstance().name(symbol);
+
+                switch (ast_.literalType(node)) {
+                case LiteralExpr::LiteralType::NUMBER: {
+                    // Same check as codegen, so both tiers reject the program
+                    int64_t number = 0;
+                    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+                    if (ec != std::errc() || end != text.data() + text.size() ||
+                        number < std::numeric_limits<int32_t>::min() || number > std::numeric_limits<int32_t>::max()) {
+                        throw std::runtime_error("Number '" + std::string(text) + "' int (32-bit) mein nahi aata");
+                    }
+                    value.kind = Value::Kind::NUMBER;
+                    value.number = static_cast<int32_t>(number);
+                    break;
+                }
+                case LiteralExpr::LiteralType::STRING:
+                    value.kind = Value::Kind::STRING;
+                    value.string = nullptr;
+                    break;
+                case LiteralExpr::LiteralType::BOOLEAN:
+                    value.kind = Value::Kind::BOOLEAN;
+                    value.boolean = symbol == Symbols::TRUE_;
+                    break;
+                case LiteralExpr::LiteralType::KHALI:
+                    value.kind = Value::Kind::KHALI;
+                    value.string = nullptr;
+                    break;
+                }
+
+                result_ = allocateRegister();
+                resultKind_ = value.kind;
+                emit(bytecode::encodeBx(OpCode::LOADK, result_, constant(symbol, value)));
+            }
+
+            void visitBinary(NodeIndex node) {
+                BinaryOp op = ast_.binaryOp(node);
+
+                visit(ast_.child(node, 0));
+                uint8_t left = result_;
+                Value::Kind leftKind = resultKind_;
+                visit(ast_.child(node, 1));
+                uint8_t right = result_;
+
+                if (leftKind != Value::Kind::BOOLEAN || resultKind_ != Value::Kind::BOOLEAN) {
+                    throw std::runtime_error(std::string("'") + (op == BinaryOp::AUR ? "aur" : "ya") +
+                                             "' needs boolean operands");
+                }
+
+                // Result overwrites the left operand; the right one is free again
+                emit(bytecode::encode(op == BinaryOp::AUR ? OpCode::AND : OpCode::OR, left, left, right));
+                nextRegister_ = left + 1;
+                result_ = left;
+                resultKind_ = Value::Kind::BOOLEAN;
+            }
+
+            void visitPrint(NodeIndex node) {
+                visitChildren(node);
+                emit(bytecode::encode(OpCode::PRINT, result_));
+            }
+
+            void visitFunction(NodeIndex node) {
+                SymbolId name = ast_.symbols[node];
+                if (!functionNames_.insert(name).second) {
+                    throw std::runtime_error("Function '" + std::string(StringInterner::getInstance().name(name)) +
+                                             "' do baar define kiya hai");
+                }
+                if (name == Symbols::MAIN) {
+                    if (ast_.function(node).paramCount != 0) {
+                        throw std::runtime_error("'main' parameters nahi le sakta");
+                    }
+                    userMain_ = program_.functions.size();
+                    if (userMain_ > 0xFFFF) {
+                        throw std::runtime_error("Bahut saare functions hain");
+                    }
+                }
+
+                beginFunction(std::string(StringInterner::getInstance().name(name)));
+                uint32_t begin = ast_.firstChild[node];
+                uint32_t end = begin + ast_.childCount[node];
+                for (uint32_t i = begin; i < end; ++i) {
+                    visit(ast_.children[i]);
+                    nextRegister_ = 0;
+                }
+                endFunction();
+            }
+
+        private:
+            static constexpr size_t NO_FUNCTION = ~size_t(0);
+
+            BytecodeProgram& program_;
+            size_t userMain_ = NO_FUNCTION;
+            std::unordered_set<SymbolId> functionNames_;
+            uint32_t currentRoot_ = BytecodeFunction::NO_ROOT;
+
+            // Current function. Constants are keyed on symbol and kind: the
+            // string "42" and the number 42 share a symbol.
+            size_t current_ = 0;
+            std::unordered_map<uint64_t, uint16_t> constantIndex_;
+            uint32_t nextRegister_ = 0;
+            uint32_t registerCount_ = 0;
+
+            // Last expression
+            uint8_t result_ = 0;
+            Value::Kind resultKind_ = Value::Kind::KHALI;
+
+            void emit(uint32_t instruction) { program_.code.push_back(instruction); }
+
+            void beginFunction(std::string name, bool entry = false) {
+                BytecodeFunction function{
+                    std::move(name),
+                    static_cast<uint32_t>(program_.code.size()),
+                    static_cast<uint32_t>(program_.constants.size()),
+                    0,
+                    currentRoot_ };
+                if (entry) {
+                    current_ = 0;
+                    program_.functions[0] = std::move(function);
+                } else {
+                    current_ = program_.functions.size();
+                    program_.functions.push_back(std::move(function));
+                }
+                constantIndex_.clear();
+                nextRegister_ = 0;
+                registerCount_ = 0;
+            }
+
+            void endFunction() {
+                emit(bytecode::encode(OpCode::RET, 0));
+                program_.functions[current_].registerCount = registerCount_;
+            }
+
+            uint8_t allocateRegister() {
+                if (nextRegister_ > 0xFF) {
+                    throw std::runtime_error("Expression bahut gehri hai (256 registers se zyada)");
+                }
+                registerCount_ = std::max(registerCount_, nextRegister_ + 1);
+                return static_cast<uint8_t>(nextRegister_++);
+            }
+
+            uint16_t constant(SymbolId symbol, Value value) {
+                uint64_t key = uint64_t(symbol) << 8 | static_cast<uint8_t>(value.kind);
+                auto found = constantIndex_.find(key);
+                if (found != constantIndex_.end()) {
+                    return found->second;
+                }
+
+                size_t index = program_.constants.size() - program_.functions[current_].constantOffset;
+                if (index > 0xFFFF) {
+                    throw std::runtime_error("Ek function mein bahut saare constants hain");
+                }
+                if (value.kind == Value::Kind::STRING) {
+                    value.string = program_.internString(StringInterner::getInstance().name(symbol));
+                }
+                program_.constants.push_back(value);
+                constantIndex_.emplace(key, static_cast<uint16_t>(index));
+                return static_cast<uint16_t>(index);
+            }
+        };
+
+    } // namespace
+
+    BytecodeProgram compileBytecode(const FlatAST& ast) {
+        BytecodeProgram program;
+        BytecodeCompiler(ast, program).compile();
+        return program;
+    }
+
+} // namespace CustomLang
@@ -1,5 +1,11 @@
 #include "codegen.hpp"
 #include "ast.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
@@ -10,6 +16,8 @@
 #include <llvm/IR/GlobalValue.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Support/raw_ostream.h>
 
 namespace CustomLang {
 
@@ -29,39 +37,253 @@ namespace CustomLang {
     
     CodeGenerator::~CodeGenerator() = default;
 
-    std::unique_ptr<llvm::Module> CodeGenerator::generateIR(
-        const std::vector<std::unique_ptr<Statement>>& ast) {
+    namespace {
+        // The user's `dekh main()`; the real main is generated
+        constexpr const char* USER_MAIN = "awara.main";
+
+        std::string topLevelName(size_t shard) {
+            return "awara.toplevel." + std::to_string(shard);
+        }
+
+        std::runtime_error duplicateFunction(std::string_view name) {
+            return std::runtime_error("Function '" + std::string(name) + "' do baar define kiya hai");
+        }
+
+        // Numbers are i32; anything that doesn't fit is an error, not a wrap
+        int32_t numberLiteral(std::string_view text) {
+            int64_t number = 0;
+            auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+            if (ec != std::errc() || end != text.data() + text.size() ||
+                number < std::numeric_limits<int32_t>::min() || number > std::numeric_limits<int32_t>::max()) {
+                throw std::runtime_error("Number '" + std::string(text) + "' int (32-bit) mein nahi aata");
+            }
+            return static_cast<int32_t>(number);
+        }
+    }
+
+    std::unique_ptr<llvm::Module> CodeGenerator::generateIR(const StatementList& ast) {
 
         // Process each top-level node
         for (const auto& node : ast) {
+            if (!dynamic_cast<FunctionDecl*>(node)) {
+                enterTopLevel();
+            }
             node->accept(*this);
         }
 
+        finishTopLevel();
+        emitEntryPoint({ topLevel_ != nullptr }, module_->getFunction(USER_MAIN) != nullptr);
+        return std::move(module_);
+    }
+
+    // Walks the flat AST and emits IR through the same helpers as the visitor
+    class CodeGenerator::FlatEmitter : public FlatASTWalker<FlatEmitter> {
+    public:
+        FlatEmitter(CodeGenerator& codegen, const FlatAST& ast)
+            : FlatASTWalker(ast), codegen_(codegen) {}
+
+        void visitLiteral(NodeIndex node) {
+            codegen_.lastValue_ = codegen_.emitLiteral(ast_.literalType(node), ast_.symbols[node]);
+        }
+
+        void visitBinary(NodeIndex node) {
+            visit(ast_.child(node, 0));
+            llvm::Value* left = codegen_.lastValue_;
+            visit(ast_.child(node, 1));
+            codegen_.lastValue_ = codegen_.emitBinary(ast_.binaryOp(node), left, codegen_.lastValue_);
+        }
+
+        void visitPrint(NodeIndex node) {
+            visitChildren(node);
+            codegen_.emitPrint(codegen_.lastValue_);
+        }
+
+        void visitFunction(NodeIndex node) {
+            const FlatAST::Function& function = ast_.function(node);
+            codegen_.currentFunction_ = codegen_.emitFunctionStart(
+                ast_.symbols[node], ast_.params.data() + function.firstParam, function.paramCount);
+            visitChildren(node);
+            codegen_.emitFunctionEnd();
+        }
+
+    private:
+        CodeGenerator& codegen_;
+    };
+
+    std::unique_ptr<llvm::Module> CodeGenerator::generateIR(const FlatAST& ast) {
+        generateRange(ast, 0, ast.roots.size());
+        emitEntryPoint({ topLevel_ != nullptr }, module_->getFunction(USER_MAIN) != nullptr);
+        return std::move(module_);
+    }
+
+    std::unique_ptr<llvm::Module> CodeGenerator::generateTopLevel(const FlatAST& ast) {
+        FlatEmitter emitter(*this, ast);
+        bool hasUserMain = false;
+        for (NodeIndex root : ast.roots) {
+            if (ast.kinds[root] == NodeKind::FUNCTION) {
+                hasUserMain |= ast.symbols[root] == Symbols::MAIN;
+                continue;
+            }
+            enterTopLevel();
+            emitter.visit(root);
+        }
+        finishTopLevel();
+        emitEntryPoint({ topLevel_ != nullptr }, hasUserMain);
         return std::move(module_);
     }
 
+    std::unique_ptr<llvm::Module> CodeGenerator::generateFunction(const FlatAST& ast, size_t root) {
+        generateRange(ast, root, root + 1);
+        return std::move(module_);
+    }
+
+    void CodeGenerator::generateRange(const FlatAST& ast, size_t firstRoot, size_t lastRoot) {
+        FlatEmitter emitter(*this, ast);
+        for (size_t i = firstRoot; i < lastRoot; ++i) {
+            if (ast.kinds[ast.roots[i]] != NodeKind::FUNCTION) {
+                enterTopLevel();
+            }
+            emitter.visit(ast.roots[i]);
+        }
+        finishTopLevel();
+    }
+
+    namespace {
+        // Below this a shard costs more to set up than it saves
+        constexpr size_t MIN_SHARD_ROOTS = 256;
+
+        // A few shards per worker evens out functions of different sizes
+        constexpr size_t SHARDS_PER_WORKER = 4;
+
+        // Root ranges [first, second) for each shard, cut before functions
+        // so a shard's top-level statements stay next to each other
+        std::vector<std::pair<size_t, size_t>> shardRoots(const FlatAST& ast, unsigned workers) {
+            size_t target = std::max(MIN_SHARD_ROOTS, ast.roots.size() / (workers * SHARDS_PER_WORKER));
+            std::vector<std::pair<size_t, size_t>> shards;
+            size_t shardStart = 0;
+
+            for (size_t i = 0; i < ast.roots.size(); ++i) {
+                if (i - shardStart >= target && ast.kinds[ast.roots[i]] == NodeKind::FUNCTION) {
+                    shards.emplace_back(shardStart, i);
+                    shardStart = i;
+                }
+            }
+
+            shards.emplace_back(shardStart, ast.roots.size());
+            return shards;
+        }
+    }
+
+    void CodeGenerator::checkFunctionNames(const FlatAST& ast) {
+        std::unordered_set<SymbolId> functionNames;
+        for (NodeIndex root : ast.roots) {
+            if (ast.kinds[root] == NodeKind::FUNCTION && !functionNames.insert(ast.symbols[root]).second) {
+                throw duplicateFunction(StringInterner::getInstance().name(ast.symbols[root]));
+            }
+        }
+    }
+
+    std::vector<llvm::orc::ThreadSafeModule> CodeGenerator::generateShards(const FlatAST& ast, ThreadPool& pool) {
+        // The shards only meet in the JIT or the linker, so catch a name
+        // defined twice here, where it reads like any other codegen error
+        checkFunctionNames(ast);
+        bool hasUserMain = false;
+        for (NodeIndex root : ast.roots) {
+            hasUserMain |= ast.kinds[root] == NodeKind::FUNCTION && ast.symbols[root] == Symbols::MAIN;
+        }
+
+        // Each shard gets its own generator, so its own context, module and
+        // runtime declarations, and is never linked with the others here
+        auto shards = shardRoots(ast, pool.size());
+        std::vector<llvm::orc::ThreadSafeModule> modules(shards.size() + 1);
+        std::vector<char> hasTopLevel(shards.size());
+        pool.forEach(shards.size(), [&](size_t i) {
+            CodeGenerator generator;
+            generator.shardIndex_ = i;
+            generator.generateRange(ast, shards[i].first, shards[i].second);
+            hasTopLevel[i] = generator.topLevel_ != nullptr;
+            modules[i + 1] = llvm::orc::ThreadSafeModule(std::move(generator.module_), generator.takeContext());
+        });
+
+        // main() gets a module of its own and calls into the shards by name
+        emitEntryPoint(std::vector<bool>(hasTopLevel.begin(), hasTopLevel.end()), hasUserMain);
+        modules[0] = llvm::orc::ThreadSafeModule(std::move(module_), takeContext());
+        return modules;
+    }
+
+    void CodeGenerator::enterTopLevel() {
+        if (!topLevel_) {
+            topLevel_ = llvm::Function::Create(
+                llvm::FunctionType::get(llvm::Type::getVoidTy(*context_), false),
+                llvm::Function::ExternalLinkage, topLevelName(shardIndex_), module_.get());
+            builder_->SetInsertPoint(llvm::BasicBlock::Create(*context_, "entry", topLevel_));
+            emitSafepoint();
+        }
+        builder_->SetInsertPoint(&topLevel_->getEntryBlock());
+    }
+
+    void CodeGenerator::finishTopLevel() {
+        if (topLevel_) {
+            builder_->SetInsertPoint(&topLevel_->getEntryBlock());
+            builder_->CreateRetVoid();
+            builder_->ClearInsertionPoint();
+            emitGCFrame(topLevel_);
+        }
+    }
+
+    void CodeGenerator::emitEntryPoint(const std::vector<bool>& shardHasTopLevel, bool hasUserMain) {
+        llvm::Function* entry = llvm::Function::Create(
+            llvm::FunctionType::get(llvm::Type::getInt32Ty(*context_), false),
+            llvm::Function::ExternalLinkage, "main", module_.get());
+        builder_->SetInsertPoint(llvm::BasicBlock::Create(*context_, "entry", entry));
+
+        for (size_t i = 0; i < shardHasTopLevel.size(); ++i) {
+            if (!shardHasTopLevel[i]) continue;
+
+            // Ours can be internal; another shard's is called by declaration
+            if (llvm::Function* topLevel = module_->getFunction(topLevelName(i))) {
+                topLevel->setLinkage(llvm::Function::InternalLinkage);
+                builder_->CreateCall(topLevel);
+            }
+            else {
+                builder_->CreateCall(module_->getOrInsertFunction(topLevelName(i),
+                    llvm::FunctionType::get(llvm::Type::getVoidTy(*context_), false)));
+            }
+        }
+        // A user-defined main runs after the top-level statements. It may
+        // live in another module, so call it through a declaration.
+        if (hasUserMain) {
+            builder_->CreateCall(module_->getOrInsertFunction(USER_MAIN,
+                llvm::FunctionType::get(llvm::Type::getVoidTy(*context_), false)));
+        }
+
+        builder_->CreateRet(llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context_), 0));
+        builder_->ClearInsertionPoint();
+    }
+
     void CodeGenerator::createKhaliConstant() {
         // Create a null pointer constant that we'll use for 'khali'
         khaliValue_ = llvm::ConstantPointerNull::get(
             llvm::PointerType::get(llvm::Type::getInt8Ty(*context_), 0));
     }
 
-    void CodeGenerator::visitLiteralExpr(LiteralExpr& expr) {
+    llvm::Value* CodeGenerator::emitLiteral(LiteralExpr::LiteralType type, SymbolId symbol) {
         llvm::Value* value = nullptr;
+        std::string_view text = StringInterner::getInstance().name(symbol);
 
-        switch (expr.type) {
+        switch (type) {
         case LiteralExpr::LiteralType::NUMBER:
             value = llvm::ConstantInt::get(*context_,
-                llvm::APInt(32, std::stoi(expr.value), true));
+                llvm::APInt(32, static_cast<uint64_t>(numberLiteral(text)), true));
             break;
 
         case LiteralExpr::LiteralType::STRING:
-            value = createStringConstant(expr.value);
+            value = createStringConstant(llvm::StringRef(text.data(), text.size()));
             break;
 
         case LiteralExpr::LiteralType::BOOLEAN:
             value = llvm::ConstantInt::get(*context_,
-                llvm::APInt(1, expr.value == "true" ? 1 : 0));
+                llvm::APInt(1, symbol == Symbols::TRUE_ ? 1 : 0));
             break;
 
         case LiteralExpr::LiteralType::KHALI:
@@ -69,71 +291,223 @@ namespace CustomLang {
             break;
         }
 
-        // Register with garbage collector if it's a heap-allocated value
+        // Heap-allocated values are read back through their shadow-stack slot
         if (value && !llvm::isa<llvm::Constant>(value)) {
-            registerWithGC(value);
+            llvm::AllocaInst* slot = emitGCRoot(value);
+            value = builder_->CreateBitCast(builder_->CreateLoad(slot->getAllocatedType(), slot), value->getType());
+        }
+
+        return value;
+    }
+
+    llvm::Value* CodeGenerator::emitBinary(BinaryOp op, llvm::Value* left, llvm::Value* right) {
+        if (!left->getType()->isIntegerTy(1) || !right->getType()->isIntegerTy(1)) {
+            throw std::runtime_error(std::string("'") + (op == BinaryOp::AUR ? "aur" : "ya") +
+                                     "' needs boolean operands");
+        }
+
+        switch (op) {
+        case BinaryOp::AUR:
+            return builder_->CreateAnd(left, right);
+        case BinaryOp::YA:
+            return builder_->CreateOr(left, right);
         }
+        return nullptr;
     }
 
-    void CodeGenerator::registerWithGC(llvm::Value* value) {
-        // Create call to GC registration function
-        std::vector<llvm::Type*> registerArgs = {
-        llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(*context_))
-        };
+    llvm::Function* CodeGenerator::emitFunctionStart(SymbolId name,
+                                                     const FunctionDecl::Param* params, size_t paramCount) {
+        std::vector<llvm::Type*> paramTypes;
+        for (size_t i = 0; i < paramCount; ++i) {
+            if (params[i].type == Symbols::INT) {
+                paramTypes.push_back(llvm::Type::getInt32Ty(*context_));
+            }
+            else if (params[i].type == Symbols::STRING) {
+                paramTypes.push_back(llvm::PointerType::get(llvm::Type::getInt8Ty(*context_), 0));
+            }
+            // Add other types as needed
+        }
+
+        llvm::FunctionType* funcType = llvm::FunctionType::get(
+            llvm::Type::getVoidTy(*context_), paramTypes, false);
 
-        llvm::FunctionType* registerType = llvm::FunctionType::get(
-            llvm::Type::getVoidTy(*context_),
-            registerArgs,
-            false);
+        std::string_view nameText = StringInterner::getInstance().name(name);
+        if (name == Symbols::MAIN) {
+            if (paramCount != 0) {
+                throw std::runtime_error("'main' parameters nahi le sakta");
+            }
+            nameText = USER_MAIN;
+        }
+
+        llvm::StringRef nameRef(nameText.data(), nameText.size());
+        if (llvm::Function* existing = module_->getFunction(nameRef); existing && !existing->isDeclaration()) {
+            throw duplicateFunction(StringInterner::getInstance().name(name));
+        }
 
-        llvm::Function* registerFunc = module_->getFunction("GC_register");
-        if (!registerFunc) {
-            registerFunc = llvm::Function::Create(
-                registerType,
-                llvm::Function::ExternalLinkage,
-                "GC_register",
-                module_.get());
+        llvm::Function* function = llvm::Function::Create(
+            funcType, llvm::Function::ExternalLinkage, nameRef, module_.get());
+
+        // Create entry block
+        llvm::BasicBlock* entryBlock = llvm::BasicBlock::Create(
+            *context_, "entry", function);
+        builder_->SetInsertPoint(entryBlock);
+
+        // String arguments may be heap objects; keep them visible to the collector
+        for (llvm::Argument& arg : function->args()) {
+            if (arg.getType()->isPointerTy()) {
+                emitGCRoot(&arg);
+            }
         }
 
-        builder_->CreateCall(registerFunc, {
-            builder_->CreateBitCast(value, llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(*context_)))
-            });
+        // With the arguments rooted, a collection can stop us here. The
+        // language has no loops yet; back edges will need a poll as well.
+        emitSafepoint();
+
+        return function;
     }
 
+    void CodeGenerator::emitFunctionEnd() {
+        llvm::Function* function = builder_->GetInsertBlock()->getParent();
 
-    void CodeGenerator::visitPrintStatement(PrintStatement& stmt) {
-        stmt.expression->accept(*this);
-        // Call print function here
+        // Functions return nothing yet
+        builder_->CreateRetVoid();
+        builder_->ClearInsertionPoint();
+        emitGCFrame(function);
+        currentFunction_ = nullptr;
     }
 
-    void CodeGenerator::visitFunctionDecl(FunctionDecl& decl) {
-    std::vector<llvm::Type*> paramTypes;
-    for (const auto& param : decl.params) {
-        if (param.type == "int") {
-            paramTypes.push_back(llvm::Type::getInt32Ty(*context_));
+    void CodeGenerator::emitPrint(llvm::Value* value) {
+        llvm::Type* type = value->getType();
+
+        // Booleans print as their literal text
+        if (type->isIntegerTy(1)) {
+            StringInterner& interner = StringInterner::getInstance();
+            std::string_view trueText = interner.name(Symbols::TRUE_);
+            std::string_view falseText = interner.name(Symbols::FALSE_);
+            value = builder_->CreateSelect(value,
+                createStringConstant(llvm::StringRef(trueText.data(), trueText.size())),
+                createStringConstant(llvm::StringRef(falseText.data(), falseText.size())));
+            type = value->getType();
+        }
+
+        if (type->isIntegerTy(32)) {
+            llvm::FunctionCallee printNumber = module_->getOrInsertFunction("dikha_number",
+                llvm::FunctionType::get(llvm::Type::getVoidTy(*context_), { type }, false));
+            builder_->CreateCall(printNumber, { value });
         }
-        else if (param.type == "string") {
-            paramTypes.push_back(llvm::PointerType::get(llvm::Type::getInt8Ty(*context_), 0));
+        else if (type->isPointerTy()) {
+            builder_->CreateCall(module_->getFunction("dikha_bhai"), { value });
         }
-        // Add other types as needed
+        else {
+            throw std::runtime_error("dikha ye value print nahi kar sakta");
+        }
+    }
+
+    void CodeGenerator::visitLiteralExpr(LiteralExpr& expr) {
+        lastValue_ = emitLiteral(expr.type, expr.value);
+    }
+
+    void CodeGenerator::visitBinaryExpr(BinaryExpr& expr) {
+        expr.left->accept(*this);
+        llvm::Value* left = lastValue_;
+        expr.right->accept(*this);
+        lastValue_ = emitBinary(expr.op, left, lastValue_);
     }
 
-    llvm::FunctionType* funcType = llvm::FunctionType::get(
-        llvm::Type::getVoidTy(*context_), paramTypes, false);
+    // Spills a GC reference into a shadow-stack slot. emitGCFrame later moves
+    // the function's slots into a frame on its thread's root chain, where the
+    // collector finds them and rewrites them if objects move, so reload the
+    // value from the slot after anything that can collect.
+    llvm::AllocaInst* CodeGenerator::emitGCRoot(llvm::Value* value) {
+        llvm::Function* function = builder_->GetInsertBlock()->getParent();
+
+        llvm::BasicBlock& entryBlock = function->getEntryBlock();
+        llvm::IRBuilder<> entry(&entryBlock, entryBlock.begin());
+        llvm::Type* bytePtr = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(*context_));
+        llvm::AllocaInst* slot = entry.CreateAlloca(bytePtr, nullptr, "gcroot");
+        gcRoots_[function].push_back(slot);
+
+        builder_->CreateStore(builder_->CreateBitCast(value, bytePtr), slot);
+        return slot;
+    }
 
-    llvm::Function* function = llvm::Function::Create(
-        funcType, llvm::Function::ExternalLinkage, decl.name, module_.get());
+    // Once a function is complete, gives its root slots a frame in the
+    // layout of awara_stack_entry: pushed onto the thread's chain on entry,
+    // popped before each return. The chain comes from GC_root_chain rather
+    // than a global so every thread has its own. An exception unwinding
+    // through the function leaves the frame linked; the runtime only throws
+    // through generated code when the program is failing anyway.
+    void CodeGenerator::emitGCFrame(llvm::Function* function) {
+        auto found = gcRoots_.find(function);
+        if (found == gcRoots_.end()) return;
+        std::vector<llvm::AllocaInst*> slots = std::move(found->second);
+        gcRoots_.erase(found);
+
+        llvm::Type* int32 = llvm::Type::getInt32Ty(*context_);
+        llvm::PointerType* bytePtr = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(*context_));
+        llvm::StructType* frameType = llvm::StructType::get(*context_,
+            { bytePtr, bytePtr, llvm::ArrayType::get(bytePtr, slots.size()) });
+
+        llvm::Constant* mapValue = llvm::ConstantStruct::getAnon(*context_,
+            { llvm::ConstantInt::get(int32, slots.size()), llvm::ConstantInt::get(int32, 0) });
+        llvm::GlobalVariable* map = new llvm::GlobalVariable(*module_, mapValue->getType(), true,
+            llvm::GlobalValue::PrivateLinkage, mapValue, function->getName() + ".gcmap");
+
+        // Slots start out null so a collection before the first store sees nothing
+        llvm::BasicBlock& entryBlock = function->getEntryBlock();
+        llvm::IRBuilder<> entry(&entryBlock, entryBlock.begin());
+        llvm::AllocaInst* frame = entry.CreateAlloca(frameType, nullptr, "gcframe");
+        std::vector<llvm::Value*> roots;
+        for (size_t i = 0; i < slots.size(); ++i) {
+            roots.push_back(entry.CreateInBoundsGEP(frameType, frame,
+                { entry.getInt32(0), entry.getInt32(2), entry.getInt32(static_cast<uint32_t>(i)) }));
+            entry.CreateStore(llvm::ConstantPointerNull::get(bytePtr), roots.back());
+        }
 
-    // Create entry block
-    llvm::BasicBlock* entryBlock = llvm::BasicBlock::Create(
-        *context_, "entry", function);
-    builder_->SetInsertPoint(entryBlock);
+        llvm::FunctionCallee rootChain = module_->getOrInsertFunction("GC_root_chain",
+            llvm::FunctionType::get(llvm::PointerType::getUnqual(bytePtr), false));
+        llvm::Value* head = entry.CreateCall(rootChain, {}, "gcchain");
+        llvm::Value* next = entry.CreateStructGEP(frameType, frame, 0);
+        entry.CreateStore(entry.CreateLoad(bytePtr, head), next);
+        entry.CreateStore(entry.CreateBitCast(map, bytePtr), entry.CreateStructGEP(frameType, frame, 1));
+        entry.CreateStore(entry.CreateBitCast(frame, bytePtr), head);
+
+        // Only now: entry's insertion point may be one of these
+        for (size_t i = 0; i < slots.size(); ++i) {
+            slots[i]->replaceAllUsesWith(roots[i]);
+            slots[i]->eraseFromParent();
+        }
 
-    // Generate code for function body
-    for (const auto& node : decl.body) {
-        node->accept(*this);
+        for (llvm::BasicBlock& block : *function) {
+            if (auto* ret = llvm::dyn_cast<llvm::ReturnInst>(block.getTerminator())) {
+                llvm::IRBuilder<> exit(ret);
+                exit.CreateStore(exit.CreateLoad(bytePtr, next), head);
+            }
+        }
+    }
+
+    // Parks this thread if a collection is waiting for it
+    void CodeGenerator::emitSafepoint() {
+        llvm::FunctionCallee safepoint = module_->getOrInsertFunction("GC_safepoint",
+            llvm::FunctionType::get(llvm::Type::getVoidTy(*context_), false));
+        builder_->CreateCall(safepoint);
+    }
+
+    void CodeGenerator::visitPrintStatement(PrintStatement& stmt) {
+        stmt.expression->accept(*this);
+        emitPrint(lastValue_);
+    }
+
+    void CodeGenerator::visitFunctionDecl(FunctionDecl& decl) {
+        currentFunction_ = emitFunctionStart(decl.name, decl.params.data(), decl.params.size());
+
+        // Generate code for function body
+        for (const auto& node : decl.body) {
+            node->accept(*this);
+        }
+
+        emitFunctionEnd();
     }
-}
 
 
     void CodeGenerator::createPrintFunction() {
@@ -147,8 +521,9 @@ namespace CustomLang {
 }
 
 
-    llvm::Value* CodeGenerator::createStringConstant(const std::string& str) {
-        return builder_->CreateGlobalStringPtr(str);
+    llvm::Value* CodeGenerator::createStringConstant(llvm::StringRef str) {
+        // Pass the module explicitly: top-level statements have no insert block
+        return builder_->CreateGlobalStringPtr(str, "", 0, module_.get());
     }
 
 } // namespace CustomLang
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "compile_cache.hpp"
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+namespace CustomLang {
+
+    namespace {
+        uint64_t hashBytes(llvm::StringRef bytes) {
+            return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(bytes));
+        }
+
+        // 0 if the file can't be read; the key then just stops depending on it
+        uint64_t hashFile(const std::string& path) {
+            auto buffer = llvm::MemoryBuffer::getFile(path);
+            return buffer ? hashBytes((*buffer)->getBuffer()) : 0;
+        }
+
+        // Everything outside a function's tokens that its optimized code
+        // depends on. Hashing the compiler binary itself means any rebuild
+        // of the compiler invalidates the cache.
+        std::string cacheSalt(OptLevel level, const llvm::TargetMachine& target) {
+            std::string salt;
+            llvm::raw_string_ostream out(salt);
+            out << "awara-cache-1:"
+                << llvm::format_hex(hashFile(llvm::sys::fs::getMainExecutable(nullptr, nullptr)), 18) << ':'
+                << llvm::format_hex(hashFile(runtimeBitcodePath()), 18) << ':'
+                << static_cast<int>(level) << ':'
+                << target.getTargetTriple().str() << ':'
+                << target.getTargetCPU() << ':'
+                << target.getTargetFeatureString() << '\n';
+            return out.str();
+        }
+
+        // Token ranges [first, second) of each top-level 'dekh ... }' in
+        // source order, which is the order of the function roots
+        std::vector<std::pair<size_t, size_t>> functionTokenRanges(const TokenBuffer& tokens) {
+            std::vector<std::pair<size_t, size_t>> ranges;
+            size_t depth = 0;
+            size_t start = 0;
+            bool inFunction = false;
+
+            for (size_t i = 0; i < tokens.size(); ++i) {
+                switch (tokens.kind(i)) {
+                case TokenType::DEKH:
+                    if (depth == 0) {
+                        start = i;
+                        inFunction = true;
+                    }
+                    break;
+                case TokenType::LEFT_BRACE:
+                    depth++;
+                    break;
+                case TokenType::RIGHT_BRACE:
+                    if (depth > 0 && --depth == 0 && inFunction) {
+                        ranges.emplace_back(start, i + 1);
+                        inFunction = false;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+            return ranges;
+        }
+
+        uint64_t functionKey(const std::string& salt, const TokenBuffer& tokens, std::pair<size_t, size_t> range) {
+            // Kinds and lexemes only: whitespace and line moves keep the key
+            std::string text = salt;
+            std::string_view source = tokens.source();
+            for (size_t i = range.first; i < range.second; ++i) {
+                const PackedToken& token = tokens.packed(i);
+                text += static_cast<char>(token.kind());
+                text.append(source.substr(token.offset, token.length()));
+                text += '\0';
+            }
+            return hashBytes(text);
+        }
+
+        void optimize(llvm::Module& module, OptLevel level, llvm::TargetMachine& target) {
+            if (level != OptLevel::O0) {
+                linkRuntimeBitcode(module);
+            }
+            optimizeModule(module, target, level, false);
+        }
+
+        llvm::SmallVector<char, 0> writeBitcode(const llvm::Module& module) {
+            llvm::SmallVector<char, 0> bitcode;
+            llvm::raw_svector_ostream stream(bitcode);
+            llvm::WriteBitcodeToFile(module, stream);
+            return bitcode;
+        }
+
+        // Generates and optimizes one function, and stores it under `key`
+        // (replacing whatever entry was there)
+        std::unique_ptr<llvm::MemoryBuffer> buildFunction(const FlatAST& ast, NodeIndex root, FunctionCache& cache,
+                                                          uint64_t key, OptLevel level) {
+            CodeGenerator generator;
+            std::unique_ptr<llvm::Module> module = generator.generateFunction(ast, root);
+            optimize(*module, level, threadTargetMachine(level));
+
+            llvm::SmallVector<char, 0> bitcode = writeBitcode(*module);
+            cache.store(key, llvm::StringRef(bitcode.data(), bitcode.size()));
+            return llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(bitcode.data(), bitcode.size()));
+        }
+    }
+
+    FunctionCache::FunctionCache(std::string directory) : directory_(std::move(directory)) {}
+
+    std::string FunctionCache::entryPath(uint64_t key) const {
+        llvm::SmallString<128> path(directory_);
+        std::string name;
+        llvm::raw_string_ostream(name) << llvm::format_hex_no_prefix(key, 16) << ".bc";
+        llvm::sys::path::append(path, name);
+        return std::string(path);
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> FunctionCache::load(uint64_t key) {
+        auto buffer = llvm::MemoryBuffer::getFile(entryPath(key));
+        if (!buffer || !llvm::isBitcode(reinterpret_cast<const unsigned char*>((*buffer)->getBufferStart()),
+                                        reinterpret_cast<const unsigned char*>((*buffer)->getBufferEnd()))) {
+            misses_++;
+            return nullptr;
+        }
+        hits_++;
+        return std::move(*buffer);
+    }
+
+    void FunctionCache::store(uint64_t key, llvm::StringRef bitcode) {
+        if (llvm::sys::fs::create_directories(directory_)) {
+            return;
+        }
+
+        std::string path = entryPath(key);
+        std::string temporary = path + ".tmp" + std::to_string(llvm::sys::Process::getProcessId());
+        {
+            std::error_code ec;
+            llvm::raw_fd_ostream out(temporary, ec, llvm::sys::fs::OF_None);
+            if (ec) {
+                return;
+            }
+            out << bitcode;
+            if (out.has_error()) {
+                out.clear_error();
+                llvm::sys::fs::remove(temporary);
+                return;
+            }
+        }
+        if (llvm::sys::fs::rename(temporary, path)) {
+            llvm::sys::fs::remove(temporary);
+        }
+    }
+
+    std::unique_ptr<llvm::Module> generateCached(CodeGenerator& codegen, const FlatAST& ast, const TokenBuffer& tokens,
+                                                 FunctionCache& cache, OptLevel level, llvm::TargetMachine& target,
+                                                 ThreadPool& pool) {
+        // Functions are generated apart and only meet in the link below
+        CodeGenerator::checkFunctionNames(ast);
+
+        std::vector<NodeIndex> functionRoots;
+        for (size_t i = 0; i < ast.roots.size(); ++i) {
+            if (ast.kinds[ast.roots[i]] == NodeKind::FUNCTION) {
+                functionRoots.push_back(static_cast<NodeIndex>(i));
+            }
+        }
+
+        auto ranges = functionTokenRanges(tokens);
+        if (ranges.size() != functionRoots.size()) {
+            throw std::runtime_error("Cache: functions aur unke tokens match nahi hue");
+        }
+
+        std::string salt = cacheSalt(level, target);
+
+        // Each function: cached bitcode, or generate + optimize + store
+        std::vector<uint64_t> keys;
+        std::vector<std::future<std::unique_ptr<llvm::MemoryBuffer>>> pending;
+        keys.reserve(functionRoots.size());
+        pending.reserve(functionRoots.size());
+        for (size_t i = 0; i < functionRoots.size(); ++i) {
+            uint64_t key = functionKey(salt, tokens, ranges[i]);
+            keys.push_back(key);
+            pending.push_back(pool.submit([&ast, &cache, level, key, root = functionRoots[i]] {
+                if (auto cached = cache.load(key)) {
+                    return cached;
+                }
+                return buildFunction(ast, root, cache, key, level);
+            }));
+        }
+
+        // Top-level statements and main are always fresh; they're small
+        std::unique_ptr<llvm::Module> module = codegen.generateTopLevel(ast);
+        optimize(*module, level, target);
+
+        // Wait for every function, then report the first error in source order
+        std::vector<std::unique_ptr<llvm::MemoryBuffer>> functions;
+        functions.reserve(pending.size());
+        std::exception_ptr firstError;
+        for (auto& future : pending) {
+            try {
+                functions.push_back(future.get());
+            } catch (...) {
+                if (!firstError) firstError = std::current_exception();
+            }
+        }
+        if (firstError) {
+            std::rethrow_exception(firstError);
+        }
+
+        llvm::Linker linker(*module);
+        for (size_t i = 0; i < functions.size(); ++i) {
+            llvm::Expected<std::unique_ptr<llvm::Module>> functionModule =
+                llvm::parseBitcodeFile(functions[i]->getMemBufferRef(), module->getContext());
+            if (!functionModule) {
+                // A damaged entry (truncated, say) is only a miss: build the
+                // function again and overwrite it
+                llvm::consumeError(functionModule.takeError());
+                cache.rejected();
+                functions[i] = buildFunction(ast, functionRoots[i], cache, keys[i], level);
+                functionModule = llvm::parseBitcodeFile(functions[i]->getMemBufferRef(), module->getContext());
+                if (!functionModule) {
+                    throw std::runtime_error("Function ka bitcode read nahi hua: " +
+                                             llvm::toString(functionModule.takeError()));
+                }
+            }
+            if (linker.linkInModule(std::move(*functionModule))) {
+                throw std::runtime_error("Functions link nahi hue");
+            }
+        }
+
+        return module;
+    }
+
+} // namespace CustomLang
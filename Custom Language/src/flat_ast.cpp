@@ -0,0 +1,86 @@
+#include "flat_ast.hpp"
+
+namespace CustomLang {
+
+    namespace {
+
+        class Flattener : public ASTVisitor {
+        public:
+            explicit Flattener(FlatAST& out) : out_(out) {}
+
+            NodeIndex flatten(ASTNode& node) {
+                node.accept(*this);
+                return last_;
+            }
+
+            void visitLiteralExpr(LiteralExpr& expr) override {
+                last_ = addNode(NodeKind::LITERAL, static_cast<uint32_t>(expr.type), expr.value);
+            }
+
+            void visitBinaryExpr(BinaryExpr& expr) override {
+                NodeIndex operands[] = { flatten(*expr.left), flatten(*expr.right) };
+                last_ = addNode(NodeKind::BINARY, static_cast<uint32_t>(expr.op), INVALID_SYMBOL);
+                setChildren(last_, operands, 2);
+            }
+
+            void visitPrintStatement(PrintStatement& stmt) override {
+                NodeIndex expression = flatten(*stmt.expression);
+                last_ = addNode(NodeKind::PRINT, 0, INVALID_SYMBOL);
+                setChildren(last_, &expression, 1);
+            }
+
+            void visitFunctionDecl(FunctionDecl& decl) override {
+                std::vector<NodeIndex> body;
+                body.reserve(decl.body.size());
+                for (Statement* statement : decl.body) {
+                    body.push_back(flatten(*statement));
+                }
+
+                FlatAST::Function function;
+                function.firstParam = static_cast<uint32_t>(out_.params.size());
+                function.paramCount = static_cast<uint32_t>(decl.params.size());
+                function.returnExpr = decl.returnExpr ? flatten(*decl.returnExpr) : FlatAST::INVALID_NODE;
+                out_.params.insert(out_.params.end(), decl.params.begin(), decl.params.end());
+
+                last_ = addNode(NodeKind::FUNCTION, static_cast<uint32_t>(out_.functions.size()), decl.name);
+                out_.functions.push_back(function);
+                setChildren(last_, body.data(), static_cast<uint32_t>(body.size()));
+            }
+
+        private:
+            FlatAST& out_;
+            NodeIndex last_ = FlatAST::INVALID_NODE;
+
+            NodeIndex addNode(NodeKind kind, uint32_t payload, SymbolId symbol) {
+                NodeIndex index = static_cast<NodeIndex>(out_.kinds.size());
+                out_.kinds.push_back(kind);
+                out_.payloads.push_back(payload);
+                out_.symbols.push_back(symbol);
+                out_.firstChild.push_back(0);
+                out_.childCount.push_back(0);
+                return index;
+            }
+
+            // Children of one node are stored next to each other
+            void setChildren(NodeIndex node, const NodeIndex* first, uint32_t count) {
+                out_.firstChild[node] = static_cast<uint32_t>(out_.children.size());
+                out_.childCount[node] = count;
+                out_.children.insert(out_.children.end(), first, first + count);
+            }
+        };
+
+    } // namespace
+
+    FlatAST flatten(const StatementList& ast) {
+        FlatAST out;
+        Flattener flattener(out);
+
+        out.roots.reserve(ast.size());
+        for (Statement* statement : ast) {
+            out.roots.push_back(flattener.flatten(*statement));
+        }
+
+        return out;
+    }
+
+} // namespace CustomLang
@@ -1,75 +1,681 @@
 #include "gc.hpp"
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+extern "C" {
+
+    uintptr_t awara_gc_nursery_start = 0;
+    uintptr_t awara_gc_nursery_end = 0;
+    uint32_t awara_gc_safepoint_requested = 0;
+    uint32_t awara_gc_marking = 0;
+
+}
 
 namespace CustomLang {
 
+    struct GarbageCollector::Mutator {
+        Heap::ThreadCache cache;
+        Nursery::Buffer eden;
+        awara_stack_entry* rootChain = nullptr;
+        std::vector<void*> markLog;     // references preWriteBarrier saved
+        size_t assistBytes = 0;         // allocated since its last mark slice
+        size_t paceBytes = 0;           // old-space bytes not yet reported to the pacer
+        bool safe = false;              // parked or in a SafeRegion
+    };
+
+    // Stops every other mutator for as long as it lives
+    class GarbageCollector::StoppedWorld {
+    public:
+        StoppedWorld(GarbageCollector& gc, Mutator& self) : gc_(gc), self_(self) {
+            // Safe while waiting, so a collection that gets in first isn't
+            // left waiting for us in turn
+            gc_.enterSafe(self_);
+            gc_.worldMutex.lock();
+
+            std::unique_lock<std::mutex> lock(gc_.parkMutex);
+            __atomic_store_n(&awara_gc_safepoint_requested, 1, __ATOMIC_RELEASE);
+            gc_.parkChanged.wait(lock, [this] {
+                return std::all_of(gc_.mutators.begin(), gc_.mutators.end(),
+                    [](Mutator* mutator) { return mutator->safe; });
+            });
+        }
+
+        ~StoppedWorld() {
+            {
+                std::lock_guard<std::mutex> lock(gc_.parkMutex);
+                __atomic_store_n(&awara_gc_safepoint_requested, 0, __ATOMIC_RELEASE);
+            }
+            gc_.parkChanged.notify_all();
+            gc_.worldMutex.unlock();
+            gc_.leaveSafe(self_);
+        }
+
+        StoppedWorld(const StoppedWorld&) = delete;
+        StoppedWorld& operator=(const StoppedWorld&) = delete;
+
+    private:
+        GarbageCollector& gc_;
+        Mutator& self_;
+    };
+
+    thread_local GarbageCollector::Mutator* GarbageCollector::current_ = nullptr;
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        // Old-space bytes a thread allocates between reports to the pacer
+        constexpr size_t PACE_CHUNK = 64 * 1024;
+
+        // Past this share of the time spent collecting, a memory limit gives way
+        constexpr double MAX_GC_FRACTION = 0.5;
+
+        // Least growth a memory limit can squeeze the goal to, as a fraction
+        // of live data and in bytes
+        constexpr double MIN_HEADROOM = 1.0 / 16;
+        constexpr size_t MIN_HEADROOM_BYTES = 1024 * 1024;
+
+        double secondsSince(Clock::time_point start) {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        ObjectHeader* headerOf(void* payload) {
+            return static_cast<ObjectHeader*>(payload) - 1;
+        }
+
+        // Sets header->remembered; returns false if it was already set.
+        // Barriers on several threads can hit one object at once, so the
+        // bit is updated by CAS on the whole header. Only minor collections
+        // clear it, with the world stopped.
+        bool setRemembered(ObjectHeader* header) {
+            static_assert(sizeof(ObjectHeader) == sizeof(uint64_t), "header must be one word");
+            uint64_t* word = reinterpret_cast<uint64_t*>(header);
+            uint64_t seen = __atomic_load_n(word, __ATOMIC_RELAXED);
+            for (;;) {
+                ObjectHeader fields;
+                std::memcpy(&fields, &seen, sizeof(fields));
+                if (fields.remembered) return false;
+
+                fields.remembered = 1;
+                uint64_t wanted;
+                std::memcpy(&wanted, &fields, sizeof(wanted));
+                if (__atomic_compare_exchange_n(word, &seen, wanted, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    return true;
+                }
+            }
+        }
+
+        bool safepointRequested() {
+            return __atomic_load_n(&awara_gc_safepoint_requested, __ATOMIC_ACQUIRE) != 0;
+        }
+
+        // Every root slot of every live generated frame on one thread
+        template <typename Visit>
+        void forEachStackRoot(awara_stack_entry* chain, Visit visit) {
+            for (awara_stack_entry* entry = chain; entry; entry = entry->next) {
+                for (int32_t i = 0; i < entry->map->numRoots; ++i) {
+                    visit(entry->roots[i]);
+                }
+            }
+        }
+
+        // Detaches the thread when it exits, if it ever attached
+        struct ThreadExit {
+            bool attached = false;
+            ~ThreadExit() {
+                if (attached) GarbageCollector::getInstance().detachThread();
+            }
+        };
+
+        thread_local ThreadExit threadExit;
+
+    } // namespace
+
     GarbageCollector& GarbageCollector::getInstance() {
         static GarbageCollector instance;
         return instance;
     }
 
+    GarbageCollector::GarbageCollector() {
+        const char* nurseryKb = std::getenv("AWARA_GC_NURSERY");
+        size_t bytes = nurseryKb ? std::strtoull(nurseryKb, nullptr, 10) * 1024 : 0;
+        if (bytes) {
+            nursery = std::make_unique<Nursery>(bytes);
+            awara_gc_nursery_start = nursery->start();
+            awara_gc_nursery_end = nursery->end();
+        }
+
+        const char* threads = std::getenv("AWARA_GC_THREADS");
+        markThreads = threads ? static_cast<unsigned>(std::strtoul(threads, nullptr, 10)) : 0;
+
+        const char* pauseMs = std::getenv("AWARA_GC_PAUSE_MS");
+        if (pauseMs) {
+            pauseBudget = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::duration<double, std::milli>(std::strtod(pauseMs, nullptr)));
+        }
+
+        const char* percent = std::getenv("AWARA_GC_PERCENT");
+        if (percent) {
+            gcPercent = std::strcmp(percent, "off") == 0 ? -1 : std::atoi(percent);
+        }
+        const char* limitMb = std::getenv("AWARA_GC_MEMORY_LIMIT");
+        memoryLimit = limitMb ? std::strtoull(limitMb, nullptr, 10) << 20 : 0;
+        headroom = MIN_HEADROOM;
+        lastCycleEnd = Clock::now();
+        setGoal();
+    }
+
+    GarbageCollector::~GarbageCollector() {
+        awara_gc_nursery_start = 0;
+        awara_gc_nursery_end = 0;
+        for (Mutator* mutator : mutators) {
+            delete mutator;
+        }
+    }
+
+    GarbageCollector::Mutator& GarbageCollector::mutator() {
+        if (!current_) attachThread();
+        return *current_;
+    }
+
+    void GarbageCollector::attachThread() {
+        if (current_) return;
+
+        Mutator* self = new Mutator;
+        {
+            std::lock_guard<std::mutex> lock(worldMutex);
+            mutators.push_back(self);
+        }
+        current_ = self;
+        threadExit.attached = true;
+    }
+
+    void GarbageCollector::detachThread() {
+        Mutator* self = current_;
+        if (!self) return;
+
+        // Taking worldMutex may mean waiting out a collection
+        enterSafe(*self);
+        {
+            std::lock_guard<std::mutex> lock(worldMutex);
+            heap.flush(self->cache);
+            orphanedLog.insert(orphanedLog.end(), self->markLog.begin(), self->markLog.end());
+            mutators.erase(std::find(mutators.begin(), mutators.end(), self));
+        }
+        current_ = nullptr;
+        threadExit.attached = false;
+        delete self;
+    }
+
+    void GarbageCollector::enterSafe(Mutator& self) {
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            self.safe = true;
+        }
+        parkChanged.notify_all();
+    }
+
+    void GarbageCollector::leaveSafe(Mutator& self) {
+        std::unique_lock<std::mutex> lock(parkMutex);
+        parkChanged.wait(lock, [] { return !safepointRequested(); });
+        self.safe = false;
+    }
+
+    // A thread already safe (inside a SafeRegion, or the collector itself)
+    // has nothing to park for. Only its own thread writes Mutator::safe.
+    void GarbageCollector::safepoint() {
+        if (current_ && !current_->safe && safepointRequested()) {
+            enterSafe(*current_);
+            leaveSafe(*current_);
+        }
+    }
+
+    awara_stack_entry** GarbageCollector::rootChain() {
+        return &mutator().rootChain;
+    }
+
+    GarbageCollector::SafeRegion::SafeRegion() {
+        GarbageCollector& gc = getInstance();
+        gc.enterSafe(gc.mutator());
+    }
+
+    GarbageCollector::SafeRegion::~SafeRegion() {
+        getInstance().leaveSafe(*current_);
+    }
+
     void* GarbageCollector::allocate(size_t size) {
-        void* mem = malloc(size + sizeof(ObjectHeader));
-        if (!mem) return nullptr;
+        return allocate(size, 0);
+    }
 
-        ObjectHeader* header = static_cast<ObjectHeader*>(mem);
-        header->size = size;
-        header->marked = false;
-        header->data = static_cast<char*>(mem) + sizeof(ObjectHeader);
+    void* GarbageCollector::allocate(size_t size, uint32_t references) {
+        Mutator& self = mutator();
+        safepoint();
+
+        size = std::max(size, references * sizeof(void*));
+        if (marking() && (self.assistBytes += size) >= MARK_ASSIST_BYTES) {
+            markSlice(self);
+        }
+        if (nursery && size <= Nursery::MAX_OBJECT_SIZE) {
+            if (void* ptr = nursery->allocate(self.eden, size, references)) return ptr;
+
+            // Threads that run out together all end up here; whoever stops
+            // the world first collects and the rest just retry
+            uint64_t cycle = cycles.load(std::memory_order_acquire);
+            {
+                StoppedWorld stopped(*this, self);
+                if (cycles.load(std::memory_order_relaxed) == cycle) {
+                    collectNursery(false);
+                }
+            }
+            // Promotion may have pushed the old space past the trigger
+            pace(self);
+            if (void* ptr = nursery->allocate(self.eden, size, references)) return ptr;
+        }
+
+        if ((self.paceBytes += size) >= PACE_CHUNK) {
+            pace(self);
+        }
+        return heap.allocate(self.cache, size, references);
+    }
+
+    void* GarbageCollector::allocateOld(size_t size, uint32_t references) {
+        Mutator& self = mutator();
+        safepoint();
+
+        if (marking() && (self.assistBytes += size) >= MARK_ASSIST_BYTES) {
+            markSlice(self);
+        }
+        if ((self.paceBytes += size) >= PACE_CHUNK) {
+            pace(self);
+        }
+        return heap.allocate(self.cache, size, references);
+    }
+
+    void GarbageCollector::setGCPercent(int percent) {
+        StoppedWorld stopped(*this, mutator());
+        gcPercent = percent;
+        setGoal();
+    }
 
-        allocatedObjects[header->data] = header;
-        return header->data;
+    void GarbageCollector::setMemoryLimit(size_t bytes) {
+        StoppedWorld stopped(*this, mutator());
+        memoryLimit = bytes;
+        setGoal();
     }
 
+    // The root and barrier entry points attach the calling thread, so a
+    // thread that only ever touches roots or reference slots is still waited
+    // for when the world stops. The root ones poll after the update, so a
+    // new root is in place before anything can move.
     void GarbageCollector::addRoot(void* ptr) {
-        if (ptr && allocatedObjects.find(ptr) != allocatedObjects.end()) {
-            roots.push_back(ptr);
+        if (!ptr) return;
+        mutator();
+        {
+            std::lock_guard<std::mutex> lock(rootsMutex);
+            roots.insert(ptr);
         }
+        safepoint();
     }
 
     void GarbageCollector::removeRoot(void* ptr) {
-        roots.erase(std::remove(roots.begin(), roots.end(), ptr), roots.end());
+        mutator();
+        {
+            std::lock_guard<std::mutex> lock(rootsMutex);
+            roots.erase(ptr);
+        }
+        safepoint();
+    }
+
+    void GarbageCollector::remember(void* object) {
+        if (nursery && nursery->contains(object)) return;
+        mutator();
+
+        // Most barriers find the object already remembered; only the one
+        // that sets the bit takes the lock to append it
+        ObjectHeader* header = headerOf(object);
+        if (setRemembered(header)) {
+            std::lock_guard<std::mutex> lock(rememberMutex);
+            rememberedSet.push_back(header);
+        }
+    }
+
+    void GarbageCollector::shade(void* ptr) {
+        mutator().markLog.push_back(ptr);
     }
 
     void GarbageCollector::collect() {
-        markPhase();
-        sweepPhase();
+        StoppedWorld stopped(*this, mutator());
+        auto start = Clock::now();
+
+        // An incremental cycle already running just gets finished
+        if (!marking()) {
+            beginMarking();
+        }
+        advanceMarking(Clock::time_point::max());
+        counters.fullSeconds += secondsSince(start);
+    }
+
+    void GarbageCollector::startCycle() {
+        StoppedWorld stopped(*this, mutator());
+        if (marking()) return;
+
+        auto start = Clock::now();
+        beginMarking();
+        if (pauseBudget.count() == 0) {
+            advanceMarking(Clock::time_point::max());
+        }
+        counters.fullSeconds += secondsSince(start);
+    }
+
+    // Reports the thread's old-space growth. Starts a cycle at the trigger,
+    // and finishes an incremental one in a single pause at the goal if
+    // marking has fallen that far behind.
+    void GarbageCollector::pace(Mutator& self) {
+        size_t allocated = allocatedSinceCycle.fetch_add(self.paceBytes, std::memory_order_relaxed) + self.paceBytes;
+        self.paceBytes = 0;
+        if (allocated < triggerBytes.load(std::memory_order_relaxed)) return;
+        if (marking() && allocated < goalBytes.load(std::memory_order_relaxed)) return;
+
+        StoppedWorld stopped(*this, self);
+        // Another thread may have seen to it while we waited
+        allocated = allocatedSinceCycle.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        if (!marking()) {
+            if (allocated < triggerBytes.load(std::memory_order_relaxed)) return;
+            counters.pacedCycles++;
+            beginMarking();
+            if (pauseBudget.count() == 0) {
+                advanceMarking(Clock::time_point::max());
+            }
+        }
+        else {
+            if (allocated < goalBytes.load(std::memory_order_relaxed)) return;
+            advanceMarking(Clock::time_point::max());
+        }
+        counters.fullSeconds += secondsSince(start);
+    }
+
+    // Goal and trigger from what the last cycle found reachable. Runs with
+    // the world stopped.
+    void GarbageCollector::setGoal() {
+        size_t live = counters.markedBytes;
+        size_t goal = SIZE_MAX;
+        if (gcPercent >= 0) {
+            goal = std::max(live + live / 100 * static_cast<size_t>(gcPercent), MIN_HEAP_GOAL);
+        }
+        if (memoryLimit) {
+            size_t young = nursery ? nursery->edenBytes() : 0;
+            size_t limited = memoryLimit > young ? memoryLimit - young : 0;
+            size_t least = live + std::max(static_cast<size_t>(live * headroom), MIN_HEADROOM_BYTES);
+            goal = std::min(goal, std::max(limited, least));
+        }
+        counters.heapGoal = goal;
+
+        // An incremental cycle starts early by what the last one allocated
+        // while it marked, so it can finish near the goal
+        size_t runway = goal == SIZE_MAX ? SIZE_MAX : goal - std::min(goal, live);
+        size_t lead = pauseBudget.count() && runway != SIZE_MAX ? std::min(markAllocated, runway / 2) : 0;
+        goalBytes.store(runway, std::memory_order_relaxed);
+        triggerBytes.store(runway - lead, std::memory_order_relaxed);
+    }
+
+    // At the end of a full cycle: what survived, what collecting has cost
+    // since the last one, and from those the next goal
+    void GarbageCollector::updatePacing() {
+        size_t allocated = allocatedSinceCycle.exchange(0, std::memory_order_relaxed);
+        markAllocated = allocated - markStartAllocated;
+        counters.markedBytes = marker->takeMarkedBytes() + markAllocated;
+
+        // Sweeping happens outside the pauses and minor collections cost the
+        // same whatever the goal, so marking is what a tighter goal buys
+        auto now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - lastCycleEnd).count();
+        double cost = elapsed > 0.0 ? (counters.markSeconds - markSecondsAtCycleEnd) / elapsed : 0.0;
+        markSecondsAtCycleEnd = counters.markSeconds;
+        lastCycleEnd = now;
+
+        // Only matters while a memory limit holds the goal down
+        if (cost > MAX_GC_FRACTION) {
+            headroom = std::min(headroom * 2, 1.0);
+        }
+        else if (cost < MAX_GC_FRACTION / 2) {
+            headroom = std::max(headroom / 2, MIN_HEADROOM);
+        }
+        setGoal();
+    }
+
+    void GarbageCollector::markSlice(Mutator& self) {
+        self.assistBytes = 0;
+        StoppedWorld stopped(*this, self);
+        if (!marking()) return;     // finished while we waited
+
+        auto start = Clock::now();
+        advanceMarking(start + pauseBudget);
+        counters.markSlices++;
+        counters.fullSeconds += secondsSince(start);
     }
 
-    void GarbageCollector::markPhase() {
+    // Takes the snapshot: greys the roots and turns on the pre-write barrier
+    // and marked allocation. Marking proper happens in advanceMarking.
+    void GarbageCollector::beginMarking() {
+        // Programs that never collect never start the helper threads
+        if (!marker) {
+            marker = std::make_unique<ParallelMarker>(heap, markThreads);
+        }
+
+        // Normally the background sweeper finished long ago
+        heap.finishSweeping();
+
+        // Empty the nursery first so marking only has the old space to cover
+        if (nursery) {
+            collectNursery(true);
+        }
+        markStartAllocated = allocatedSinceCycle.load(std::memory_order_relaxed);
+
+        // Threads in a SafeRegion aren't stopped and may still add roots
+        std::lock_guard<std::mutex> lock(rootsMutex);
         for (void* root : roots) {
-            markObject(root);
+            // After a full evacuation only pinned objects are left in the
+            // nursery, and every one of them is a root. They have no mark
+            // bit and may move before the next slice, so scan them now.
+            if (nursery && nursery->contains(root)) {
+                ObjectHeader* header = headerOf(root);
+                for (uint32_t i = 0; i < header->references; ++i) {
+                    markObject(header->referenceSlots()[i]);
+                }
+            }
+            else {
+                markObject(root);
+            }
         }
+        for (Mutator* mutator : mutators) {
+            forEachStackRoot(mutator->rootChain, [this](void* slot) { markObject(slot); });
+        }
+
+        __atomic_store_n(&awara_gc_marking, 1, __ATOMIC_RELAXED);
+        heap.setAllocateMarked(true);
+    }
+
+    // Marks until the grey set is empty or the deadline passes. Finishing
+    // sweeps and ends the cycle; returns whether it did.
+    bool GarbageCollector::advanceMarking(Clock::time_point deadline) {
+        auto start = Clock::now();
+
+        for (Mutator* mutator : mutators) {
+            for (void* ptr : mutator->markLog) {
+                markObject(ptr);
+            }
+            mutator->markLog.clear();
+        }
+        for (void* ptr : orphanedLog) {
+            markObject(ptr);
+        }
+        orphanedLog.clear();
+
+        bool done = marker->mark(greyObjects, deadline);
+        counters.markSeconds += secondsSince(start);
+        if (!done) return false;
+
+        __atomic_store_n(&awara_gc_marking, 0, __ATOMIC_RELAXED);
+        heap.setAllocateMarked(false);
+        sweepPhase();
+        updatePacing();
+
+        counters.fullCollections++;
+        cycles.fetch_add(1, std::memory_order_release);
+        return true;
     }
 
     void GarbageCollector::markObject(void* ptr) {
-        auto it = allocatedObjects.find(ptr);
-        if (it != allocatedObjects.end() && !it->second->marked) {
-            it->second->marked = true;
-            // Here you would recursively mark any referenced objects
-            // This depends on your object structure
+        if (ObjectHeader* header = heap.tryMark(ptr)) {
+            greyObjects.push_back(header);
         }
     }
 
+    // Only queues the sweeping; the heap does it after the pause
     void GarbageCollector::sweepPhase() {
-        auto it = allocatedObjects.begin();
-        while (it != allocatedObjects.end()) {
-            if (!it->second->marked) {
-                free(it->second); // Free the memory
-                it = allocatedObjects.erase(it);
+        // Remembered objects that just died must not be scanned again
+        {
+            std::lock_guard<std::mutex> lock(rememberMutex);
+            rememberedSet.erase(std::remove_if(rememberedSet.begin(), rememberedSet.end(),
+                [this](ObjectHeader* header) { return !heap.isMarked(header->payload()); }),
+                rememberedSet.end());
+        }
+
+        // Sweeping rebuilds the page lists, so every cached page goes back
+        for (Mutator* mutator : mutators) {
+            heap.flush(mutator->cache);
+        }
+        heap.flush(promotionCache);
+        heap.sweep();
+    }
+
+    // Copies everything reachable from the roots and the remembered set out of
+    // eden and survivor space, then recycles both. Objects named by value roots
+    // are pinned in place since the roots can't be updated. Runs with the
+    // world stopped.
+    void GarbageCollector::collectNursery(bool promoteAll) {
+        auto start = Clock::now();
+        size_t promotedBefore = counters.promotedBytes;
+
+        {
+            std::lock_guard<std::mutex> lock(rootsMutex);
+            for (void* root : roots) {
+                if (!nursery->contains(root)) continue;
+
+                ObjectHeader* header = headerOf(root);
+                if (!header->pinned) {
+                    header->pinned = 1;
+                    nursery->pin(root);
+                    pinnedObjects.push_back(header);
+                    markStack.push_back(header);
+                }
             }
-            else {
-                it->second->marked = false; // Reset mark for next collection
-                ++it;
+        }
+
+        // Stack slots can be updated, so what they name moves like anything else
+        for (Mutator* mutator : mutators) {
+            forEachStackRoot(mutator->rootChain,
+                [this, promoteAll](void*& slot) { evacuate(slot, promoteAll); });
+        }
+
+        std::vector<ObjectHeader*> remembered;
+        {
+            std::lock_guard<std::mutex> lock(rememberMutex);
+            remembered.swap(rememberedSet);
+        }
+        for (ObjectHeader* header : remembered) {
+            header->remembered = 0;
+            markStack.push_back(header);
+        }
+
+        // Scan pinned, remembered and copied objects alike. An old object left
+        // pointing into the nursery (at a pinned object or a survivor) stays
+        // remembered.
+        while (!markStack.empty()) {
+            ObjectHeader* header = markStack.back();
+            markStack.pop_back();
+
+            bool pointsYoung = false;
+            void** slots = header->referenceSlots();
+            for (uint32_t i = 0; i < header->references; ++i) {
+                evacuate(slots[i], promoteAll);
+                pointsYoung |= nursery->contains(slots[i]);
+            }
+            if (pointsYoung) {
+                remember(header->payload());
             }
         }
+
+        for (ObjectHeader* header : pinnedObjects) {
+            header->pinned = 0;
+        }
+        pinnedObjects.clear();
+        nursery->flip();
+        for (Mutator* mutator : mutators) {
+            mutator->eden = Nursery::Buffer{};
+        }
+
+        // Promotion grows the old space like any other allocation there
+        allocatedSinceCycle.fetch_add(counters.promotedBytes - promotedBefore, std::memory_order_relaxed);
+
+        // A full collection's evacuation is accounted to the full collection
+        if (!promoteAll) {
+            counters.minorCollections++;
+            counters.minorSeconds += secondsSince(start);
+            cycles.fetch_add(1, std::memory_order_release);
+        }
     }
 
-    GarbageCollector::~GarbageCollector() {
-        // Clean up all remaining objects
-        for (auto& pair : allocatedObjects) {
-            free(pair.second);
+    void GarbageCollector::evacuate(void*& slot, bool promoteAll) {
+        void* ptr = slot;
+        if (!nursery->contains(ptr)) return;
+
+        ObjectHeader* header = headerOf(ptr);
+        if (header->forwarded) {
+            slot = *static_cast<void**>(ptr);
+            return;
+        }
+        if (header->pinned) return;
+
+        uint32_t age = header->age + 1;
+        ObjectHeader* copy = nullptr;
+        if (!promoteAll && age < PROMOTION_AGE) {
+            copy = nursery->allocateSurvivor(header->size);
+        }
+        if (copy) {
+            copy->references = header->references;
+            copy->age = age;
+            counters.survivorBytes += header->size;
         }
+        else {
+            void* payload = heap.allocate(promotionCache, header->size, header->references);
+            if (!payload) {
+                throw std::runtime_error("Promotion ke liye memory allocate nahi hui");
+            }
+            copy = headerOf(payload);
+            counters.promotedBytes += header->size;
+        }
+
+        std::memcpy(copy->payload(), ptr, header->size);
+        header->forwarded = 1;
+        *static_cast<void**>(ptr) = copy->payload();
+        slot = copy->payload();
+        markStack.push_back(copy);
+    }
+
+    GarbageCollector::Stats GarbageCollector::stats() {
+        StoppedWorld stopped(*this, mutator());
+        // Unswept pages would count their dead cells as live
+        heap.finishSweeping();
+        Stats stats = counters;
+        stats.heap = heap.stats();
+        stats.nurseryBytes = nursery ? nursery->edenBytes() : 0;
+        stats.markThreads = marker ? marker->threads() : 0;
+        return stats;
     }
 
 } // namespace CustomLang
\ No newline at end of file
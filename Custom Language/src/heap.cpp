@@ -0,0 +1,484 @@
+#include "heap.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+
+namespace CustomLang {
+
+    namespace {
+
+        constexpr size_t HEADER_SIZE = sizeof(ObjectHeader);
+        constexpr size_t OS_PAGE_SIZE = 4096;
+
+        // Empty pages kept resident after a sweep; the cells of the rest go
+        // back to the OS
+        constexpr size_t EMPTY_PAGE_RESERVE = 16;
+
+        // Pages the background sweeper sweeps per turn of the heap lock
+        constexpr size_t SWEEP_BATCH = 32;
+
+        // Cell sizes, header included; neighbours are at most 25% apart
+        constexpr uint32_t CELL_SIZES[] = {
+            16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256,
+            320, 384, 448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048
+        };
+        static_assert(sizeof(CELL_SIZES) / sizeof(CELL_SIZES[0]) == Heap::CLASS_COUNT,
+                      "CLASS_COUNT is out of date");
+        static_assert(CELL_SIZES[Heap::CLASS_COUNT - 1] == Heap::MAX_CELL_SIZE,
+                      "largest class must be MAX_CELL_SIZE");
+
+        // Granule count -> smallest class that fits
+        struct ClassTable {
+            uint8_t byGranules[Heap::MAX_CELL_SIZE / Heap::GRANULE + 1] = {};
+
+            constexpr ClassTable() {
+                size_t cls = 0;
+                for (size_t granules = 0; granules <= Heap::MAX_CELL_SIZE / Heap::GRANULE; ++granules) {
+                    while (CELL_SIZES[cls] < granules * Heap::GRANULE) ++cls;
+                    byGranules[granules] = static_cast<uint8_t>(cls);
+                }
+            }
+        };
+
+        constexpr ClassTable classTable{};
+
+        size_t roundUp(size_t value, size_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        void* mapMemory(size_t size) {
+            void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return mem == MAP_FAILED ? nullptr : mem;
+        }
+
+        // mmap only promises OS-page alignment; over-map and trim both ends
+        void* mapAligned(size_t size, size_t alignment) {
+            size_t span = size + alignment;
+            char* raw = static_cast<char*>(mapMemory(span));
+            if (!raw) return nullptr;
+
+            char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(raw), alignment));
+            if (aligned > raw) munmap(raw, aligned - raw);
+            size_t tail = (raw + span) - (aligned + size);
+            if (tail) munmap(aligned + size, tail);
+            return aligned;
+        }
+
+        inline int countTrailingZeros(uint64_t word) {
+            return __builtin_ctzll(word);
+        }
+
+    } // namespace
+
+    struct Heap::FreeCell {
+        FreeCell* next;
+    };
+
+    // Lives at the start of its own PAGE_SIZE-aligned mapping. Bitmaps have one
+    // bit per granule of the page; only bits at cell starts are ever set.
+    struct Heap::Page {
+        static constexpr size_t BITMAP_WORDS = PAGE_SIZE / GRANULE / 64;
+
+        char* cells;
+        char* bump;             // first cell never handed out
+        char* end;              // one past the last whole cell
+        FreeCell* freeList;
+        uint32_t cellSize;
+        uint32_t liveCells;
+        uint8_t sizeClass;
+        uint64_t liveBits[BITMAP_WORDS];
+        uint64_t markBits[BITMAP_WORDS];
+
+        static size_t cellsOffset() { return roundUp(sizeof(Page), GRANULE); }
+
+        // Expects every live/mark bit to be clear
+        void format(size_t cls) {
+            sizeClass = static_cast<uint8_t>(cls);
+            cellSize = CELL_SIZES[cls];
+            cells = reinterpret_cast<char*>(this) + cellsOffset();
+            end = cells + (PAGE_SIZE - cellsOffset()) / cellSize * cellSize;
+            bump = cells;
+            freeList = nullptr;
+            liveCells = 0;
+        }
+
+        size_t bitIndex(const char* cell) const {
+            return static_cast<size_t>(cell - reinterpret_cast<const char*>(this)) / GRANULE;
+        }
+
+        bool hasFreeCells() const { return freeList || bump < end; }
+
+        // marked: allocated during incremental marking, so already black
+        char* take(bool marked) {
+            char* cell;
+            if (freeList) {
+                cell = reinterpret_cast<char*>(freeList);
+                freeList = freeList->next;
+            }
+            else if (bump < end) {
+                cell = bump;
+                bump += cellSize;
+            }
+            else {
+                return nullptr;
+            }
+
+            size_t bit = bitIndex(cell);
+            liveBits[bit / 64] |= uint64_t(1) << (bit % 64);
+            if (marked) {
+                markBits[bit / 64] |= uint64_t(1) << (bit % 64);
+            }
+            ++liveCells;
+            return cell;
+        }
+
+        // Dead cells go on the free list; live bits become this cycle's marks
+        void sweep() {
+            char* base = reinterpret_cast<char*>(this);
+            for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+                uint64_t dead = liveBits[word] & ~markBits[word];
+                liveBits[word] = markBits[word];
+                markBits[word] = 0;
+
+                while (dead) {
+                    size_t bit = word * 64 + countTrailingZeros(dead);
+                    dead &= dead - 1;
+
+                    FreeCell* cell = reinterpret_cast<FreeCell*>(base + bit * GRANULE);
+                    cell->next = freeList;
+                    freeList = cell;
+                    --liveCells;
+                }
+            }
+        }
+    };
+
+    struct Heap::LargeObject {
+        size_t mappedBytes;
+        bool marked;
+        ObjectHeader header;    // payload follows
+
+        static size_t headerOffset() { return offsetof(LargeObject, header); }
+    };
+
+    Heap::~Heap() {
+        if (sweeper_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            sweepWanted_.notify_one();
+            sweeper_.join();
+        }
+
+        for (Page* page : pages_) {
+            munmap(page, PAGE_SIZE);
+        }
+        for (auto& entry : largeObjects_) {
+            munmap(entry.second, entry.second->mappedBytes);
+        }
+        for (LargeObject* object : deadLargeObjects_) {
+            munmap(object, object->mappedBytes);
+        }
+    }
+
+    void* Heap::allocate(ThreadCache& cache, size_t size, uint32_t references) {
+        if (references > ObjectHeader::MAX_REFERENCES) return nullptr;
+        size = std::max(size, references * sizeof(void*));
+        if (size > MAX_CELL_SIZE - HEADER_SIZE) {
+            return allocateLarge(size, references);
+        }
+
+        size_t cls = classTable.byGranules[(size + HEADER_SIZE + GRANULE - 1) / GRANULE];
+        Page* page = cache.current[cls];
+        char* cell = page ? page->take(allocateMarked_) : nullptr;
+        if (!cell) {
+            page = refill(cache, cls);
+            if (!page) return nullptr;
+            cell = page->take(allocateMarked_);
+        }
+
+        cache.allocatedBytes += page->cellSize;
+        ++cache.allocations;
+
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(cell);
+        *header = ObjectHeader{};
+        header->size = static_cast<uint32_t>(size);
+        header->references = references;
+        std::memset(header->payload(), 0, references * sizeof(void*));
+        return header->payload();
+    }
+
+    // Next page for a class whose cached page is full: a swept page with
+    // holes, then an unswept page of the class, swept here and now, then an
+    // empty page, resident before released, then a fresh mapping. Full pages
+    // are simply dropped; the next sweep finds them through pages_.
+    Heap::Page* Heap::refill(ThreadCache& cache, size_t sizeClass) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        allocatedBytes_ += cache.allocatedBytes;
+        allocations_ += cache.allocations;
+        cache.allocatedBytes = 0;
+        cache.allocations = 0;
+
+        std::vector<Page*>& available = available_[sizeClass];
+        std::vector<Page*>& unswept = unswept_[sizeClass];
+        Page* page = nullptr;
+
+        if (!available.empty()) {
+            page = available.back();
+            available.pop_back();
+        }
+        while (!page && !unswept.empty()) {
+            Page* candidate = unswept.back();
+            unswept.pop_back();
+            candidate->sweep();
+            if (candidate->hasFreeCells()) {
+                page = candidate;
+            }
+        }
+
+        if (!page) {
+            std::vector<Page*>& empty = !emptyPages_.empty() ? emptyPages_ : releasedPages_;
+            if (!empty.empty()) {
+                page = empty.back();
+                empty.pop_back();
+                page->format(sizeClass);
+            }
+            else {
+                void* mem = mapAligned(PAGE_SIZE, PAGE_SIZE);
+                if (!mem) return nullptr;
+                page = new (mem) Page{};
+                page->format(sizeClass);
+                pages_.insert(std::upper_bound(pages_.begin(), pages_.end(), page), page);
+            }
+        }
+
+        cache.current[sizeClass] = page;
+        return page;
+    }
+
+    void Heap::flush(ThreadCache& cache) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t cls = 0; cls < CLASS_COUNT; ++cls) {
+            Page* page = cache.current[cls];
+            if (page && page->hasFreeCells()) {
+                available_[cls].push_back(page);
+            }
+            cache.current[cls] = nullptr;
+        }
+
+        allocatedBytes_ += cache.allocatedBytes;
+        allocations_ += cache.allocations;
+        cache.allocatedBytes = 0;
+        cache.allocations = 0;
+    }
+
+    void* Heap::allocateLarge(size_t size, uint32_t references) {
+        size_t bytes = roundUp(LargeObject::headerOffset() + HEADER_SIZE + size, OS_PAGE_SIZE);
+        void* mem = mapMemory(bytes);
+        if (!mem) return nullptr;
+
+        // Fresh anonymous mappings are already zeroed
+        LargeObject* object = new (mem) LargeObject{};
+        object->mappedBytes = bytes;
+        object->marked = allocateMarked_;
+        object->header = ObjectHeader{};
+        object->header.size = static_cast<uint32_t>(size);
+        object->header.references = references;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        largeObjects_.emplace(reinterpret_cast<uintptr_t>(object->header.payload()), object);
+        allocatedBytes_ += bytes;
+        ++allocations_;
+        return object->header.payload();
+    }
+
+    Heap::Page* Heap::pageFor(const void* ptr) const {
+        Page* page = reinterpret_cast<Page*>(reinterpret_cast<uintptr_t>(ptr) & ~(PAGE_SIZE - 1));
+        auto it = std::lower_bound(pages_.begin(), pages_.end(), page);
+        return it != pages_.end() && *it == page ? page : nullptr;
+    }
+
+    ObjectHeader* Heap::find(const void* ptr) const {
+        if (!ptr) return nullptr;
+
+        if (Page* page = pageFor(ptr)) {
+            const char* cell = static_cast<const char*>(ptr) - HEADER_SIZE;
+            if (cell < page->cells || cell >= page->bump) return nullptr;
+            if (reinterpret_cast<uintptr_t>(cell) % GRANULE != 0) return nullptr;
+
+            size_t bit = page->bitIndex(cell);
+            if (!(page->liveBits[bit / 64] & (uint64_t(1) << (bit % 64)))) return nullptr;
+            return reinterpret_cast<ObjectHeader*>(const_cast<char*>(cell));
+        }
+
+        auto it = largeObjects_.find(reinterpret_cast<uintptr_t>(ptr));
+        return it != largeObjects_.end() ? &it->second->header : nullptr;
+    }
+
+    ObjectHeader* Heap::tryMark(const void* ptr) {
+        if (!ptr) return nullptr;
+
+        if (Page* page = pageFor(ptr)) {
+            // Live bits sit only at cell starts, so a granule-aligned cell with
+            // its bit set proves ptr is a payload and not an interior pointer
+            const char* cell = static_cast<const char*>(ptr) - HEADER_SIZE;
+            if (cell < page->cells || reinterpret_cast<uintptr_t>(cell) % GRANULE != 0) return nullptr;
+
+            size_t bit = page->bitIndex(cell);
+            uint64_t mask = uint64_t(1) << (bit % 64);
+            if (!(page->liveBits[bit / 64] & mask)) return nullptr;
+
+            // Markers race for objects; whoever sets the bit traces it. A load
+            // first spares already-marked objects the locked instruction.
+            uint64_t* marks = &page->markBits[bit / 64];
+            if (__atomic_load_n(marks, __ATOMIC_RELAXED) & mask) return nullptr;
+            if (__atomic_fetch_or(marks, mask, __ATOMIC_RELAXED) & mask) return nullptr;
+            return reinterpret_cast<ObjectHeader*>(const_cast<char*>(cell));
+        }
+
+        auto it = largeObjects_.find(reinterpret_cast<uintptr_t>(ptr));
+        if (it == largeObjects_.end()) return nullptr;
+        if (__atomic_exchange_n(&it->second->marked, true, __ATOMIC_RELAXED)) return nullptr;
+        return &it->second->header;
+    }
+
+    bool Heap::isMarked(const void* ptr) const {
+        if (Page* page = pageFor(ptr)) {
+            size_t bit = page->bitIndex(static_cast<const char*>(ptr) - HEADER_SIZE);
+            return page->markBits[bit / 64] & (uint64_t(1) << (bit % 64));
+        }
+
+        auto it = largeObjects_.find(reinterpret_cast<uintptr_t>(ptr));
+        return it != largeObjects_.end() && it->second->marked;
+    }
+
+    // Costs a pass over the page list but touches no page
+    void Heap::sweep() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (std::vector<Page*>& available : available_) {
+            available.clear();
+        }
+
+        // Walk high to low so allocation, which pops from the back, sweeps
+        // and fills the lowest pages first
+        for (auto it = pages_.rbegin(); it != pages_.rend(); ++it) {
+            Page* page = *it;
+            if (page->liveCells == 0 && page->bump == page->cells) continue;   // already empty
+            unswept_[page->sizeClass].push_back(page);
+        }
+
+        for (auto it = largeObjects_.begin(); it != largeObjects_.end();) {
+            LargeObject* object = it->second;
+            if (object->marked) {
+                object->marked = false;
+                ++it;
+            }
+            else {
+                deadLargeObjects_.push_back(object);
+                it = largeObjects_.erase(it);
+            }
+        }
+
+        if (!sweeper_.joinable()) {
+            sweeper_ = std::thread([this] { sweeperLoop(); });
+        }
+        sweepPending_ = true;
+        lock.unlock();
+        sweepWanted_.notify_one();
+    }
+
+    void Heap::finishSweeping() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (std::vector<Page*>& unswept : unswept_) {
+            while (!unswept.empty()) {
+                sweepPage(unswept.back());
+                unswept.pop_back();
+            }
+        }
+
+        // Releasing the surplus is still the sweeper's job
+        if (emptyPages_.size() > EMPTY_PAGE_RESERVE && sweeper_.joinable()) {
+            sweepPending_ = true;
+            lock.unlock();
+            sweepWanted_.notify_one();
+        }
+    }
+
+    // Files a page by what sweeping left in it. Called with the lock held.
+    void Heap::sweepPage(Page* page) {
+        page->sweep();
+        if (page->liveCells == 0) {
+            page->format(page->sizeClass);
+            emptyPages_.push_back(page);
+        }
+        else if (page->hasFreeCells()) {
+            available_[page->sizeClass].push_back(page);
+        }
+    }
+
+    void Heap::sweeperLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            sweepWanted_.wait(lock, [this] { return stopping_ || sweepPending_; });
+            if (stopping_) return;
+            sweepPending_ = false;
+
+            // A batch at a time, so allocating threads can get at the lock and
+            // memory starts going back before the whole heap is swept
+            while (true) {
+                size_t swept = 0;
+                for (std::vector<Page*>& unswept : unswept_) {
+                    while (!unswept.empty() && swept < SWEEP_BATCH) {
+                        sweepPage(unswept.back());
+                        unswept.pop_back();
+                        ++swept;
+                    }
+                }
+
+                // The system calls run unlocked, on memory no list holds meanwhile
+                std::vector<LargeObject*> dead;
+                dead.swap(deadLargeObjects_);
+                std::vector<Page*> surplus;
+                if (emptyPages_.size() > EMPTY_PAGE_RESERVE) {
+                    surplus.assign(emptyPages_.begin() + EMPTY_PAGE_RESERVE, emptyPages_.end());
+                    emptyPages_.resize(EMPTY_PAGE_RESERVE);
+                }
+                if (swept == 0 && dead.empty() && surplus.empty()) break;
+                lock.unlock();
+
+                for (LargeObject* object : dead) {
+                    munmap(object, object->mappedBytes);
+                }
+                // The page reads back as zeros, which is a valid empty header
+                for (Page* page : surplus) {
+                    madvise(page, PAGE_SIZE, MADV_DONTNEED);
+                }
+
+                lock.lock();
+                releasedPages_.insert(releasedPages_.end(), surplus.begin(), surplus.end());
+            }
+        }
+    }
+
+    Heap::Stats Heap::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats;
+        stats.pages = pages_.size();
+        stats.releasedPages = releasedPages_.size();
+        stats.largeObjects = largeObjects_.size();
+        stats.committedBytes = (pages_.size() - releasedPages_.size()) * PAGE_SIZE;
+        for (Page* page : pages_) {
+            stats.liveBytes += static_cast<size_t>(page->liveCells) * page->cellSize;
+        }
+        for (auto& entry : largeObjects_) {
+            stats.committedBytes += entry.second->mappedBytes;
+            stats.liveBytes += entry.second->mappedBytes;
+        }
+        stats.allocatedBytes = allocatedBytes_;
+        stats.allocations = allocations_;
+        return stats;
+    }
+
+} // namespace CustomLang
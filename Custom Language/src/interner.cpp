@@ -0,0 +1,189 @@
+#include "interner.hpp"
+#include <cstring>
+#include <functional>
+#include <mutex>
+
+namespace CustomLang {
+
+    namespace {
+        // The symbols one thread has already interned. IDs and their stored
+        // text never change once handed out, so a hit here needs no lock;
+        // only text the thread hasn't met before goes to the shared table.
+        // Holds at most what the shared table does.
+        class LocalSymbols {
+        public:
+            SymbolId find(std::string_view text, size_t hash) const {
+                if (table_.empty()) return INVALID_SYMBOL;
+
+                size_t mask = table_.size() - 1;
+                for (size_t slot = hash & mask; table_[slot].id != INVALID_SYMBOL; slot = (slot + 1) & mask) {
+                    const Entry& entry = table_[slot];
+                    if (entry.hash == hash && entry.text == text) {
+                        return entry.id;
+                    }
+                }
+                return INVALID_SYMBOL;
+            }
+
+            // `text` must be the interner's stored copy, not the caller's
+            void add(std::string_view text, size_t hash, SymbolId id) {
+                // Keep the table at most half full
+                if ((used_ + 1) * 2 > table_.size()) {
+                    grow();
+                }
+
+                size_t mask = table_.size() - 1;
+                size_t slot = hash & mask;
+                while (table_[slot].id != INVALID_SYMBOL) slot = (slot + 1) & mask;
+                table_[slot] = Entry{ hash, text, id };
+                ++used_;
+            }
+
+        private:
+            struct Entry {
+                size_t hash = 0;
+                std::string_view text;
+                SymbolId id = INVALID_SYMBOL;
+            };
+
+            std::vector<Entry> table_;
+            size_t used_ = 0;
+
+            void grow() {
+                std::vector<Entry> table(table_.empty() ? 1024 : table_.size() * 2);
+                size_t mask = table.size() - 1;
+
+                for (const Entry& entry : table_) {
+                    if (entry.id == INVALID_SYMBOL) continue;
+                    size_t slot = entry.hash & mask;
+                    while (table[slot].id != INVALID_SYMBOL) slot = (slot + 1) & mask;
+                    table[slot] = entry;
+                }
+
+                table_.swap(table);
+            }
+        };
+
+        thread_local LocalSymbols localSymbols;
+    }
+
+    StringInterner& StringInterner::getInstance() {
+        static StringInterner instance;
+        return instance;
+    }
+
+    StringInterner::StringInterner() {
+        table_.assign(1024, INVALID_SYMBOL);
+
+        // Must match the constants in Symbols
+        for (std::string_view text : { "int", "string", "float", "bool", "true", "false", "khali", "main" }) {
+            intern(text);
+        }
+    }
+
+    SymbolId StringInterner::intern(std::string_view text) {
+        size_t hash = std::hash<std::string_view>{}(text);
+
+        SymbolId id = localSymbols.find(text, hash);
+        if (id != INVALID_SYMBOL) return id;
+
+        std::string_view stored;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            id = find(text, hash);
+            if (id != INVALID_SYMBOL) stored = names_[id];
+        }
+
+        if (id == INVALID_SYMBOL) {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            // Someone may have added it between the two locks
+            id = find(text, hash);
+            if (id == INVALID_SYMBOL) id = insert(text, hash);
+            stored = names_[id];
+        }
+
+        localSymbols.add(stored, hash, id);
+        return id;
+    }
+
+    std::string_view StringInterner::name(SymbolId id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return names_[id];
+    }
+
+    size_t StringInterner::size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return names_.size();
+    }
+
+    size_t StringInterner::bytesStored() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return bytesStored_;
+    }
+
+    SymbolId StringInterner::find(std::string_view text, size_t hash) const {
+        size_t mask = table_.size() - 1;
+        for (size_t slot = hash & mask; table_[slot] != INVALID_SYMBOL; slot = (slot + 1) & mask) {
+            SymbolId id = table_[slot];
+            if (hashes_[id] == hash && names_[id] == text) {
+                return id;
+            }
+        }
+        return INVALID_SYMBOL;
+    }
+
+    SymbolId StringInterner::insert(std::string_view text, size_t hash) {
+        // Keep the table at most half full
+        if ((names_.size() + 1) * 2 > table_.size()) {
+            grow();
+        }
+
+        SymbolId id = static_cast<SymbolId>(names_.size());
+        names_.push_back(store(text));
+        hashes_.push_back(hash);
+
+        size_t mask = table_.size() - 1;
+        size_t slot = hash & mask;
+        while (table_[slot] != INVALID_SYMBOL) slot = (slot + 1) & mask;
+        table_[slot] = id;
+
+        return id;
+    }
+
+    std::string_view StringInterner::store(std::string_view text) {
+        if (text.empty()) return {};
+
+        bytesStored_ += text.size();
+
+        // Oversized strings get an allocation of their own
+        if (text.size() > BLOCK_SIZE / 4) {
+            largeStrings_.emplace_back(new char[text.size()]);
+            std::memcpy(largeStrings_.back().get(), text.data(), text.size());
+            return std::string_view(largeStrings_.back().get(), text.size());
+        }
+
+        if (BLOCK_SIZE - blockUsed_ < text.size()) {
+            blocks_.emplace_back(new char[BLOCK_SIZE]);
+            blockUsed_ = 0;
+        }
+
+        char* destination = blocks_.back().get() + blockUsed_;
+        std::memcpy(destination, text.data(), text.size());
+        blockUsed_ += text.size();
+        return std::string_view(destination, text.size());
+    }
+
+    void StringInterner::grow() {
+        std::vector<SymbolId> table(table_.size() * 2, INVALID_SYMBOL);
+        size_t mask = table.size() - 1;
+
+        for (SymbolId id = 0; id < names_.size(); ++id) {
+            size_t slot = hashes_[id] & mask;
+            while (table[slot] != INVALID_SYMBOL) slot = (slot + 1) & mask;
+            table[slot] = id;
+        }
+
+        table_.swap(table);
+    }
+
+} // namespace CustomLang
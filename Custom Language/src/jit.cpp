@@ -0,0 +1,80 @@
+#include "jit.hpp"
+#include "runtime.hpp"
+#include <chrono>
+#include <stdexcept>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/Error.h>
+
+namespace CustomLang {
+
+    namespace {
+        template <typename T>
+        T unwrap(llvm::Expected<T> value, const char* what) {
+            if (!value) {
+                throw std::runtime_error(std::string(what) + ": " + llvm::toString(value.takeError()));
+            }
+            return std::move(*value);
+        }
+
+        void check(llvm::Error error, const char* what) {
+            if (error) {
+                throw std::runtime_error(std::string(what) + ": " + llvm::toString(std::move(error)));
+            }
+        }
+    }
+
+    Jit::Jit(unsigned compileThreads) {
+        jit_ = unwrap(llvm::orc::LLJITBuilder().setNumCompileThreads(compileThreads).create(), "JIT nahi bana");
+
+        // Bind the runtime in this process instead of searching libraries
+        llvm::orc::SymbolMap runtimeSymbols;
+        llvm::orc::MangleAndInterner mangle(jit_->getExecutionSession(), jit_->getDataLayout());
+        for (const auto& [name, address] : Runtime::symbols()) {
+            runtimeSymbols[mangle(name)] = llvm::orc::ExecutorSymbolDef(
+                llvm::orc::ExecutorAddr::fromPtr(address), llvm::JITSymbolFlags::Exported);
+        }
+        check(jit_->getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(runtimeSymbols))),
+              "Runtime symbols bind nahi hue");
+    }
+
+    Jit::~Jit() = default;
+
+    void Jit::addModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context) {
+        addModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)));
+    }
+
+    void Jit::addModule(llvm::orc::ThreadSafeModule module) {
+        module.withModuleDo([this](llvm::Module& m) { m.setDataLayout(jit_->getDataLayout()); });
+        check(jit_->addIRModule(std::move(module)), "Module JIT mein nahi gaya");
+    }
+
+    void* Jit::lookup(const std::string& name) {
+        llvm::orc::ExecutorAddr address = unwrap(jit_->lookup(name), "Symbol nahi mila");
+        return address.toPtr<void*>();
+    }
+
+    JitResult runJit(std::vector<llvm::orc::ThreadSafeModule> modules, unsigned compileThreads) {
+        using Clock = std::chrono::steady_clock;
+        auto start = Clock::now();
+
+        Jit jit(modules.size() > 1 ? compileThreads : 0);
+        for (llvm::orc::ThreadSafeModule& module : modules) {
+            jit.addModule(std::move(module));
+        }
+
+        // Lookup materializes main, so this is where machine code is generated
+        auto mainFunction = reinterpret_cast<int (*)()>(jit.lookup("main"));
+        auto compiled = Clock::now();
+
+        int exitCode = mainFunction();
+        auto finished = Clock::now();
+
+        return JitResult{
+            exitCode,
+            std::chrono::duration<double>(compiled - start).count(),
+            std::chrono::duration<double>(finished - compiled).count()
+        };
+    }
+
+} // namespace CustomLang
@@ -1,4 +1,6 @@
 #include "lexer.hpp"
+#include "keywords.hpp"
+#include "scanner.hpp"
 #include <stdexcept>
 #include <sstream>
 
@@ -32,20 +34,67 @@ namespace CustomLang {
     }
 
     Token Lexer::makeToken(TokenType type) {
-        std::string text = source_.substr(start_, current_ - start_);
-        Token token(type, text, line_, column_ - text.length());
+        std::string_view text(source_.data() + start_, current_ - start_);
+        Token token(type, text, line_, column_ - static_cast<int>(text.length()));
+        switch (type) {
+        case TokenType::IDENTIFIER:
+        case TokenType::NUMBER_LITERAL:
+        case TokenType::FLOAT_LITERAL:
+        case TokenType::BOOLEAN_LITERAL:
+            token.symbol = StringInterner::getInstance().intern(text);
+            break;
+        default:
+            break;
+        }
         return token;
     }
 
+    void Lexer::advanceTo(const char* pos) {
+        size_t target = static_cast<size_t>(pos - source_.data());
+        column_ += static_cast<int>(target - current_);
+        current_ = target;
+    }
+
+    void Lexer::newlineAt(const char* pos) {
+        // The byte after the newline is column 1
+        line_++;
+        column_ = 1;
+        current_ = static_cast<size_t>(pos - source_.data()) + 1;
+    }
+
     Token Lexer::string() {
-        while (peek() != '"' && !isAtEnd()) {
-            if (peek() == '\n') {
-                line_++;
-                column_ = 1;
+        bool hasEscapes = false;
+        int startLine = line_;
+        int startColumn = column_ - 1;
+
+        const char* end = source_.data() + source_.length();
+        const char* p = source_.data() + current_;
+
+        // Jump between '"', '\\' and '\n' instead of walking every byte
+        while (true) {
+            p = scan::findStringStop(p, end);
+            if (p == end || *p == '"') break;
+
+            if (*p == '\n') {
+                newlineAt(p);
+                p++;
+                continue;
+            }
+
+            // Skip the escaped character so \" doesn't end the literal
+            hasEscapes = true;
+            if (p + 1 == end) {
+                p = end;
+                break;
             }
-            advance();
+            if (p[1] == '\n') {
+                newlineAt(p + 1);
+            }
+            p += 2;
         }
 
+        advanceTo(p);
+
         if (isAtEnd()) {
             throw std::runtime_error("Unterminated string at line " +
                 std::to_string(line_));
@@ -55,20 +104,55 @@ namespace CustomLang {
         advance();
 
         // Get the string content (without the quotes)
-        std::string value = source_.substr(start_ + 1, current_ - start_ - 2);
-        return Token(TokenType::STRING_LITERAL, value, line_, column_);
+        std::string_view value(source_.data() + start_ + 1, current_ - start_ - 2);
+        Token token(TokenType::STRING_LITERAL, value, startLine, startColumn);
+        // Only escaped literals need a cooked copy before interning
+        if (hasEscapes) {
+            unescapeString(value, scratch_);
+        }
+        token.symbol = StringInterner::getInstance().intern(
+            hasEscapes ? std::string_view(scratch_) : value);
+        return token;
+    }
+
+    void unescapeString(std::string_view body, std::string& result) {
+        result.clear();
+        result.reserve(body.size());
+
+        for (size_t i = 0; i < body.size(); ++i) {
+            char c = body[i];
+            if (c != '\\' || i + 1 == body.size()) {
+                result.push_back(c);
+                continue;
+            }
+
+            switch (body[++i]) {
+            case 'n': result.push_back('\n'); break;
+            case 't': result.push_back('\t'); break;
+            case 'r': result.push_back('\r'); break;
+            case '0': result.push_back('\0'); break;
+            case '"': result.push_back('"'); break;
+            case '\\': result.push_back('\\'); break;
+            default:
+                // Unknown escape: keep it verbatim
+                result.push_back('\\');
+                result.push_back(body[i]);
+                break;
+            }
+        }
     }
 
     Token Lexer::number() {
         bool isFloat = false;
+        const char* end = source_.data() + source_.length();
 
-        while (isdigit(peek())) advance();
+        advanceTo(scan::skipDigits(source_.data() + current_, end));
 
         // Look for decimal part
-        if (peek() == '.' && isdigit(peekNext())) {
+        if (peek() == '.' && scan::is(peekNext(), scan::CC_DIGIT)) {
             isFloat = true;
             advance(); // Consume the .
-            while (isdigit(peek())) advance();
+            advanceTo(scan::skipDigits(source_.data() + current_, end));
         }
 
         return makeToken(isFloat ? TokenType::FLOAT_LITERAL : TokenType::NUMBER_LITERAL);
@@ -84,22 +168,17 @@ namespace CustomLang {
         char c = advance();
 
         // Handle identifiers and keywords
-        if (isalpha(c) || c == '_') {
-            while (isalnum(peek()) || peek() == '_' || peek() == '.') advance();
+        if (scan::is(c, scan::CC_IDENT_START)) {
+            advanceTo(scan::skipIdentifier(source_.data() + current_, source_.data() + source_.length()));
 
-            std::string text = source_.substr(start_, current_ - start_);
+            std::string_view text(source_.data() + start_, current_ - start_);
 
             // Check if it's a keyword
-            auto it = keywords_.find(text);
-            if (it != keywords_.end()) {
-                return makeToken(it->second);
-            }
-
-            return makeToken(TokenType::IDENTIFIER);
+            return makeToken(keywords::lookup(text));
         }
 
         // Handle numbers
-        if (isdigit(c)) {
+        if (scan::is(c, scan::CC_DIGIT)) {
             return number();
         }
 
@@ -124,23 +203,13 @@ namespace CustomLang {
     }
 
     void Lexer::skipWhitespace() {
-        while (true) {
-            char c = peek();
-            switch (c) {
-            case ' ':
-            case '\r':
-            case '\t':
-                advance();
-                break;
-            case '\n':
-                line_++;
-                column_ = 1;
-                advance();
-                break;
-            default:
-                return;
-            }
+        scan::WhitespaceRun run = scan::skipWhitespace(source_.data() + current_,
+                                                       source_.data() + source_.length());
+        if (run.newlines > 0) {
+            line_ += run.newlines - 1;
+            newlineAt(run.lastNewline);
         }
+        advanceTo(run.end);
     }
 
 } // namespace CustomLang
\ No newline at end of file
@@ -2,18 +2,37 @@
 #include "parser.hpp"
 #include "codegen.hpp"
 #include "runtime.hpp"
+#include "source_buffer.hpp"
+#include "arena.hpp"
+#include "flat_ast.hpp"
+#include "token_buffer.hpp"
+#include "parallel_parser.hpp"
+#include "thread_pool.hpp"
 #include "colors.hpp"
+#include "jit.hpp"
+#include "optimizer.hpp"
+#include "backend.hpp"
+#include "compile_cache.hpp"
+#include "bytecode.hpp"
+#include "vm.hpp"
+#include "tiering.hpp"
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
+#include <atomic>
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <filesystem>
+#include <chrono>
 #include <cstdlib>
+#include <optional>
+#include <vector>
 #include "ast.hpp"
 
 bool hasValidExtension(const std::string& filename) {
+    if (filename == "-") {
+        return true; // stdin
+    }
     std::filesystem::path path(filename);
     std::string ext = path.extension().string();
     return ext == ".awara" || ext == ".aw";
@@ -38,7 +57,7 @@ void logError(const std::string& baseMessage, const std::string& context = "", c
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        logError("Usage: " + std::string(argv[0]) + " <source_file.awara> [--emit-llvm] [--verbose] [--output=<binary_name>]",
+        logError("Usage: " + std::string(argv[0]) + " <source_file.awara | -> [--emit-llvm] [--emit-obj] [--run] [--interpret [--tier-threshold=<calls>] [--tier-log]] [-O0|-O1|-O2|-O3|-Os] [--print-pass-timings] [--cache-dir=<dir>] [--gc-percent=<n|off>] [--gc-memory-limit=<MiB>] [--verbose] [--jobs=<n>] [--output=<binary_name>]",
                 "No input file provided",
                 "Please provide a source file with .awara or .aw extension");
         return 1;
@@ -46,16 +65,68 @@ int main(int argc, char* argv[]) {
 
     std::string sourceFile = argv[1];
     bool emitLLVM = false;
+    bool emitObject = false;
+    bool run = false;
+    bool interpret = false;
+    uint32_t tierThreshold = 0; // 0 = never leave the interpreter
+    bool tierLog = false;
+    CustomLang::OptLevel optLevel = CustomLang::OptLevel::O0;
+    bool printPassTimings = false;
     bool verbose = false;
+    unsigned jobs = 0; // 0 = one per hardware thread
     std::string outputBinary = "output";
+    std::string cacheDir;
 
     // Parse optional arguments
     for (int i = 2; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--emit-llvm") {
             emitLLVM = true;
+        } else if (arg == "--emit-obj") {
+            emitObject = true;
+        } else if (arg == "--run") {
+            run = true;
+        } else if (arg == "--interpret") {
+            interpret = true;
+        } else if (arg.find("--tier-threshold=") == 0) {
+            tierThreshold = static_cast<uint32_t>(std::strtoul(arg.c_str() + 17, nullptr, 10));
+            if (tierThreshold == 0) {
+                std::cerr << "--tier-threshold needs a positive number" << std::endl;
+                return 2;
+            }
+        } else if (arg == "--tier-log") {
+            tierLog = true;
+        } else if (auto level = CustomLang::parseOptLevel(arg)) {
+            optLevel = *level;
+        } else if (arg == "--print-pass-timings") {
+            printPassTimings = true;
         } else if (arg == "--verbose") {
             verbose = true;
+        } else if (arg.find("--jobs=") == 0) {
+            jobs = static_cast<unsigned>(std::strtoul(arg.c_str() + 7, nullptr, 10));
+            if (jobs == 0) {
+                std::cerr << "--jobs needs a positive number" << std::endl;
+                return 2;
+            }
+        } else if (arg.find("--gc-percent=") == 0) {
+            std::string value = arg.substr(13);
+            if (value == "off") {
+                CustomLang::Runtime::setGCPercent(-1);
+            } else if (!value.empty() && value.find_first_not_of("0123456789") == std::string::npos) {
+                CustomLang::Runtime::setGCPercent(std::atoi(value.c_str()));
+            } else {
+                std::cerr << "--gc-percent needs a number or off" << std::endl;
+                return 2;
+            }
+        } else if (arg.find("--gc-memory-limit=") == 0) {
+            size_t limitMb = std::strtoull(arg.c_str() + 18, nullptr, 10);
+            if (limitMb == 0) {
+                std::cerr << "--gc-memory-limit needs a positive number of MiB" << std::endl;
+                return 2;
+            }
+            CustomLang::Runtime::setMemoryLimit(limitMb << 20);
+        } else if (arg.find("--cache-dir=") == 0) {
+            cacheDir = arg.substr(12);
         } else if (arg.find("--output=") == 0) {
             outputBinary = arg.substr(9);
         } else {
@@ -71,24 +142,18 @@ int main(int argc, char* argv[]) {
         return 3;
     }
 
-    // Initialize LLVM
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
-
     try {
-        // Read source file
-        std::ifstream file(sourceFile);
-        if (!file.is_open()) {
+        // Map the source file (or read stdin); the lexer works on it in place
+        CustomLang::SourceBuffer source;
+        try {
+            source = CustomLang::SourceBuffer::open(sourceFile);
+        } catch (const std::exception& e) {
             logError("Could not open file",
-                    "File: " + sourceFile,
+                    e.what(),
                     "Check if the file exists and you have permission to read it");
             return 4;
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string source = buffer.str();
-
         if (source.empty()) {
             logError("Source file is empty",
                     "File: " + sourceFile,
@@ -99,14 +164,25 @@ int main(int argc, char* argv[]) {
         // Initialize runtime
         CustomLang::Runtime::initialize();
 
-        // Create lexer and parser
-        CustomLang::Lexer lexer(source);
-        CustomLang::Parser parser(lexer);
+        // All AST nodes live in this arena and are dropped together after codegen
+        CustomLang::AstArena astArena;
+        astArena.setTimed(verbose);
+
+        // Workers for the parallel stages. The interpreter is for short
+        // scripts and skips the thread startup.
+        std::optional<CustomLang::ThreadPool> pool;
+        if (!interpret) {
+            pool.emplace(jobs);
+        }
 
-        // Parse source code
-        std::vector<std::unique_ptr<CustomLang::Statement>> ast;
+        // Parse source code: lex the whole file into a token array, then parse
+        // independent top-level declarations concurrently
+        CustomLang::StatementList ast(&astArena);
+        CustomLang::TokenBuffer tokens;
         try {
-            ast = parser.parse();
+            tokens = CustomLang::TokenBuffer::lex(source.view());
+            ast = pool ? CustomLang::parseParallel(tokens, astArena, *pool)
+                       : CustomLang::Parser(tokens, astArena).parse();
             if (verbose) {
                 std::cout << "Parsing completed successfully." << std::endl;
             }
@@ -117,13 +193,102 @@ int main(int argc, char* argv[]) {
             return 6;
         }
 
-        // Generate LLVM IR
+        // Lower to the flat, index-based AST that codegen walks
+        CustomLang::FlatAST flatAst = CustomLang::flatten(ast);
+
+        // Nothing allocates from the arena after this, in either mode
+        if (verbose) {
+            std::cout << "AST arena: " << astArena.nodeCount() << " nodes, "
+                      << astArena.bytesUsed() << " bytes used ("
+                      << astArena.bytesReserved() << " reserved), "
+                      << astArena.allocationSeconds() * 1000.0 << " ms allocating" << std::endl;
+        }
+
+        if (interpret) {
+            // Compile to bytecode and run it here, without touching LLVM
+            auto start = std::chrono::steady_clock::now();
+            CustomLang::BytecodeProgram program;
+            try {
+                program = CustomLang::compileBytecode(flatAst);
+            } catch (const std::exception& e) {
+                logError("Code Generation Error",
+                        e.what(),
+                        "Check your semantic rules and try again");
+                return 7;
+            }
+            auto compiled = std::chrono::steady_clock::now();
+
+            // Hot functions move to LLVM in the background
+            std::unique_ptr<CustomLang::TierManager> tiers;
+            if (tierThreshold > 0) {
+                llvm::InitializeNativeTarget();
+                llvm::InitializeNativeTargetAsmPrinter();
+                tiers = std::make_unique<CustomLang::TierManager>(flatAst, program, tierThreshold, tierLog);
+            }
+
+            CustomLang::VM vm;
+            vm.setTiering(tiers.get());
+            vm.run(program);
+
+            if (verbose) {
+                auto finished = std::chrono::steady_clock::now();
+                std::cout << "Bytecode compile: " << std::chrono::duration<double>(compiled - start).count() * 1000.0
+                          << " ms, execute: " << std::chrono::duration<double>(finished - compiled).count() * 1000.0
+                          << " ms" << std::endl;
+            }
+            return 0;
+        }
+
+        // Initialize LLVM
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        // Target for optimization and native code
+        std::unique_ptr<llvm::TargetMachine> targetMachine;
+        try {
+            targetMachine = CustomLang::createHostTargetMachine(optLevel);
+        } catch (const std::exception& e) {
+            logError("Target Error",
+                    e.what(),
+                    "This LLVM build may not support your machine");
+            return 13;
+        }
+
+        // Optional per-function cache of optimized code
+        std::unique_ptr<CustomLang::FunctionCache> functionCache;
+        if (!cacheDir.empty()) {
+            functionCache = std::make_unique<CustomLang::FunctionCache>(cacheDir);
+        }
+
+        // Generate LLVM IR. Programs that are run or linked are generated in
+        // shards, one module each, and stay that way down to the JIT or one
+        // object file per shard. --emit-llvm and --emit-obj write a single
+        // file, so they get a single module.
         CustomLang::CodeGenerator codegen;
-        std::unique_ptr<llvm::Module> module;
+        std::vector<llvm::orc::ThreadSafeModule> modules;
         try {
-            module = codegen.generateIR(ast); // Changed to accept vector of statements
-            if (verbose) {
-                std::cout << "Code generation completed successfully." << std::endl;
+            if (functionCache) {
+                // Unchanged functions come back already optimized
+                std::unique_ptr<llvm::Module> module = CustomLang::generateCached(
+                    codegen, flatAst, tokens, *functionCache, optLevel, *targetMachine, *pool);
+                modules.emplace_back(std::move(module), codegen.takeContext());
+                if (verbose) {
+                    std::cout << "Code generation completed successfully (cache " << functionCache->directory()
+                              << ": " << functionCache->hits() << " hits, "
+                              << functionCache->misses() << " misses)." << std::endl;
+                }
+            } else if (emitLLVM || emitObject) {
+                std::unique_ptr<llvm::Module> module = codegen.generateIR(flatAst);
+                modules.emplace_back(std::move(module), codegen.takeContext());
+                if (verbose) {
+                    std::cout << "Code generation completed successfully (1 module)." << std::endl;
+                }
+            } else {
+                modules = codegen.generateShards(flatAst, *pool);
+                if (verbose) {
+                    std::cout << "Code generation completed successfully ("
+                              << modules.size() - 1 << " shards)." << std::endl;
+                }
             }
         } catch (const std::exception& e) {
             logError("Code Generation Error",
@@ -132,6 +297,55 @@ int main(int argc, char* argv[]) {
             return 7;
         }
 
+        // The IR no longer references the AST; free it in one go
+        flatAst = CustomLang::FlatAST();
+        ast = CustomLang::StatementList(&astArena);
+        astArena.release();
+
+        // Optimize for the host CPU (cached functions already are). Shards
+        // are optimized side by side, each worker with its own TargetMachine.
+        if (!functionCache) {
+            try {
+                auto start = std::chrono::steady_clock::now();
+
+                std::atomic<bool> runtimeLinked{true};
+                auto optimize = [&](llvm::orc::ThreadSafeModule& shard, llvm::TargetMachine& target) {
+                    shard.withModuleDo([&](llvm::Module& module) {
+                        // Bring in the runtime's fast paths so they can inline
+                        if (optLevel != CustomLang::OptLevel::O0 && !CustomLang::linkRuntimeBitcode(module)) {
+                            runtimeLinked = false;
+                        }
+                        CustomLang::optimizeModule(module, target, optLevel, printPassTimings);
+                    });
+                };
+                if (printPassTimings || modules.size() == 1) {
+                    // Pass timings are global; keep one report per module
+                    for (llvm::orc::ThreadSafeModule& shard : modules) {
+                        optimize(shard, *targetMachine);
+                    }
+                } else {
+                    pool->forEach(modules.size(), [&](size_t i) {
+                        optimize(modules[i], CustomLang::threadTargetMachine(optLevel));
+                    });
+                }
+
+                if (verbose && !runtimeLinked) {
+                    std::cout << "Runtime bitcode not found at " << CustomLang::runtimeBitcodePath()
+                              << "; runtime calls stay external." << std::endl;
+                }
+                if (verbose) {
+                    std::cout << "Optimization completed in "
+                              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0
+                              << " ms." << std::endl;
+                }
+            } catch (const std::exception& e) {
+                logError("Optimization Error",
+                        e.what(),
+                        "Try a lower -O level");
+                return 11;
+            }
+        }
+
         if (emitLLVM) {
             // Emit LLVM IR to a file
             std::string llvmIRFilename = outputBinary + ".ll";
@@ -143,11 +357,66 @@ int main(int argc, char* argv[]) {
                         "Check your write permissions and available disk space");
                 return 8;
             }
-            module->print(llvmIRFile, nullptr);
+            modules.front().withModuleDo([&](llvm::Module& module) { module.print(llvmIRFile, nullptr); });
             std::cout << "LLVM IR emitted to " << llvmIRFilename << std::endl;
-        } else {
-            // Execute or compile binary (placeholder for further logic)
-            std::cout << "Compilation or execution of binary would proceed here." << std::endl;
+        }
+
+        if (run) {
+            // JIT-compile and execute main in this process
+            CustomLang::JitResult result;
+            try {
+                result = CustomLang::runJit(std::move(modules), pool->size());
+            } catch (const std::exception& e) {
+                logError("JIT Error",
+                        e.what(),
+                        "Check that the program defines what it calls");
+                return 10;
+            }
+            if (verbose) {
+                std::cout << "JIT compile: " << result.compileSeconds * 1000.0 << " ms, execute: "
+                          << result.executeSeconds * 1000.0 << " ms" << std::endl;
+            }
+            return result.exitCode;
+        } else if (!emitLLVM || emitObject) {
+            // Native objects, one per module and emitted side by side, then
+            // (unless --emit-obj) an executable linked with the runtime
+            try {
+                auto start = std::chrono::steady_clock::now();
+                std::vector<std::string> objectFilenames(modules.size());
+                for (size_t i = 0; i < modules.size(); ++i) {
+                    objectFilenames[i] = modules.size() == 1 ? outputBinary + ".o"
+                                                             : outputBinary + "." + std::to_string(i) + ".o";
+                }
+                pool->forEach(modules.size(), [&](size_t i) {
+                    modules[i].withModuleDo([&](llvm::Module& module) {
+                        CustomLang::emitObjectFile(module, CustomLang::threadTargetMachine(optLevel),
+                                                   objectFilenames[i]);
+                    });
+                });
+                auto emitted = std::chrono::steady_clock::now();
+
+                if (emitObject) {
+                    std::cout << "Object file emitted to " << objectFilenames.front() << std::endl;
+                } else {
+                    CustomLang::linkExecutable(objectFilenames, outputBinary);
+                    for (const std::string& objectFilename : objectFilenames) {
+                        std::filesystem::remove(objectFilename);
+                    }
+                    std::cout << "Executable written to " << outputBinary << std::endl;
+                }
+
+                if (verbose) {
+                    auto linked = std::chrono::steady_clock::now();
+                    std::cout << "Object emission: " << std::chrono::duration<double>(emitted - start).count() * 1000.0
+                              << " ms, link: " << std::chrono::duration<double>(linked - emitted).count() * 1000.0
+                              << " ms" << std::endl;
+                }
+            } catch (const std::exception& e) {
+                logError("Native Code Error",
+                        e.what(),
+                        "Check that a C++ toolchain is installed, or set CXX / AWARA_RUNTIME");
+                return 12;
+            }
         }
 
         return 0;
@@ -0,0 +1,182 @@
+#include "marker.hpp"
+
+namespace CustomLang {
+
+    namespace {
+        // Objects scanned between looks at the clock in a timed round
+        constexpr uint32_t DEADLINE_CHECK_INTERVAL = 64;
+    }
+
+    ParallelMarker::ParallelMarker(Heap& heap, unsigned threads) : heap_(heap) {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        if (threads == 0) {
+            threads = 1;
+        }
+
+        for (unsigned i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+            workers_.back()->seed = 0x9E3779B97F4A7C15ull * (i + 1);
+        }
+        helpers_.reserve(threads - 1);
+        for (unsigned i = 1; i < threads; ++i) {
+            helpers_.emplace_back([this, i] { helperLoop(i); });
+        }
+    }
+
+    ParallelMarker::~ParallelMarker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+
+        for (std::thread& helper : helpers_) {
+            helper.join();
+        }
+    }
+
+    bool ParallelMarker::mark(std::vector<ObjectHeader*>& grey, Clock::time_point deadline) {
+        // Deal the roots out so every marker starts with something. The
+        // helpers are asleep, so filling their deques from here is safe.
+        for (size_t i = 0; i < grey.size(); ++i) {
+            workers_[i % workers_.size()]->deque.push(grey[i]);
+        }
+        grey.clear();
+
+        idle_.store(0, std::memory_order_relaxed);
+        expired_.store(false, std::memory_order_relaxed);
+        deadline_ = deadline;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++round_;
+            running_ = static_cast<unsigned>(helpers_.size());
+        }
+        wake_.notify_all();
+
+        trace(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        finished_.wait(lock, [this] { return running_ == 0; });
+
+        // Out of time: hand back what is left. The owners are asleep again.
+        ObjectHeader* header = nullptr;
+        for (auto& worker : workers_) {
+            while (worker->deque.pop(header)) {
+                grey.push_back(header);
+            }
+            worker->deque.reset();
+        }
+        return grey.empty();
+    }
+
+    size_t ParallelMarker::takeMarkedBytes() {
+        size_t bytes = 0;
+        for (auto& worker : workers_) {
+            bytes += worker->markedBytes;
+            worker->markedBytes = 0;
+        }
+        return bytes;
+    }
+
+    void ParallelMarker::helperLoop(unsigned index) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this, seen] { return stopping_ || round_ != seen; });
+                if (stopping_) return;
+                seen = round_;
+            }
+
+            trace(index);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --running_;
+            }
+            finished_.notify_one();
+        }
+    }
+
+    void ParallelMarker::trace(unsigned index) {
+        WorkStealingDeque<ObjectHeader*>& deque = workers_[index]->deque;
+        size_t& markedBytes = workers_[index]->markedBytes;
+        ObjectHeader* header = nullptr;
+        bool timed = deadline_ != Clock::time_point::max();
+        uint32_t untilCheck = DEADLINE_CHECK_INTERVAL;
+
+        while (true) {
+            while (deque.pop(header) || steal(index, header)) {
+                // Follow the first newly marked child directly and publish
+                // the rest; that halves the deque traffic on trees and lists
+                while (header) {
+                    markedBytes += header->size;
+                    ObjectHeader* next = nullptr;
+                    void** slots = header->referenceSlots();
+                    for (uint32_t i = 0; i < header->references; ++i) {
+                        if (ObjectHeader* child = heap_.tryMark(slots[i])) {
+                            if (next) {
+                                deque.push(child);
+                            }
+                            else {
+                                next = child;
+                            }
+                        }
+                    }
+                    header = next;
+
+                    if (timed && --untilCheck == 0) {
+                        untilCheck = DEADLINE_CHECK_INTERVAL;
+                        if (Clock::now() >= deadline_) {
+                            expired_.store(true, std::memory_order_relaxed);
+                        }
+                    }
+                    if (expired_.load(std::memory_order_relaxed)) {
+                        if (header) deque.push(header);
+                        return;
+                    }
+                }
+            }
+
+            // An idle marker's deque is empty and only its owner could refill
+            // it, so once every marker is idle there is nothing left anywhere.
+            // Until then, go back to stealing as soon as work shows up.
+            idle_.fetch_add(1, std::memory_order_acq_rel);
+            while (true) {
+                if (idle_.load(std::memory_order_acquire) == workers_.size()) return;
+                if (expired_.load(std::memory_order_relaxed)) return;
+                if (anyWork()) break;
+                std::this_thread::yield();
+            }
+            idle_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    bool ParallelMarker::steal(unsigned index, ObjectHeader*& header) {
+        size_t count = workers_.size();
+        if (count == 1) return false;
+
+        // Start at a random victim so thieves don't all pile onto one deque
+        uint64_t& seed = workers_[index]->seed;
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        size_t first = seed % count;
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (first + i) % count;
+            if (victim != index && workers_[victim]->deque.steal(header)) return true;
+        }
+        return false;
+    }
+
+    bool ParallelMarker::anyWork() const {
+        for (const auto& worker : workers_) {
+            if (!worker->deque.empty()) return true;
+        }
+        return false;
+    }
+
+} // namespace CustomLang
@@ -0,0 +1,83 @@
+#include "nursery.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <sys/mman.h>
+
+namespace CustomLang {
+
+    Nursery::Nursery(size_t edenBytes) {
+        edenBlocks_ = std::max<size_t>(1, (edenBytes + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        size_t blocks = edenBlocks_ * 2;
+        reservedBytes_ = blocks * BLOCK_SIZE;
+
+        void* mem = mmap(nullptr, reservedBytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            throw std::runtime_error("Nursery ke liye memory nahi mili");
+        }
+        base_ = static_cast<char*>(mem);
+
+        pinned_.assign(blocks, 0);
+        // Popped from the back, so eden starts at the low end
+        for (size_t i = blocks; i-- > 0;) {
+            freeBlocks_.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    Nursery::~Nursery() {
+        munmap(base_, reservedBytes_);
+    }
+
+    bool Nursery::takeBlock(std::vector<uint32_t>& space, Buffer& buffer) {
+        if (freeBlocks_.empty()) return false;
+
+        uint32_t block = freeBlocks_.back();
+        freeBlocks_.pop_back();
+        space.push_back(block);
+        buffer.cursor = base_ + static_cast<size_t>(block) * BLOCK_SIZE;
+        buffer.limit = buffer.cursor + BLOCK_SIZE;
+        return true;
+    }
+
+    bool Nursery::nextEdenBlock(Buffer& eden) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return edenUsed_.size() < edenBlocks_ && takeBlock(edenUsed_, eden);
+    }
+
+    ObjectHeader* Nursery::allocateSurvivor(size_t size) {
+        size_t bytes = objectBytes(size);
+        if (static_cast<size_t>(survivor_.limit - survivor_.cursor) < bytes && !takeBlock(toSpace_, survivor_)) {
+            return nullptr;
+        }
+
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(survivor_.cursor);
+        survivor_.cursor += bytes;
+        *header = ObjectHeader{};
+        header->size = static_cast<uint32_t>(size);
+        return header;
+    }
+
+    void Nursery::pin(const void* ptr) {
+        pinned_[blockIndex(ptr)] = 1;
+    }
+
+    void Nursery::flip() {
+        std::vector<uint32_t> survivors = std::move(toSpace_);
+        for (const std::vector<uint32_t>* space : { &edenUsed_, &fromSpace_ }) {
+            for (uint32_t block : *space) {
+                if (pinned_[block]) {
+                    survivors.push_back(block);
+                    pinned_[block] = 0;
+                }
+                else {
+                    freeBlocks_.push_back(block);
+                }
+            }
+        }
+
+        fromSpace_ = std::move(survivors);
+        toSpace_.clear();
+        edenUsed_.clear();
+        survivor_ = Buffer{};
+    }
+
+} // namespace CustomLang
@@ -0,0 +1,177 @@
+#include "optimizer.hpp"
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Analysis/LoopAnalysisManager.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/IR/PassTimingInfo.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/StandardInstrumentations.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/TargetParser/Host.h>
+#include <llvm/Transforms/IPO/Internalize.h>
+
+// Set by CMake to the built runtime bitcode
+#ifndef AWARA_RUNTIME_BITCODE
+#define AWARA_RUNTIME_BITCODE "awara_runtime.bc"
+#endif
+
+namespace CustomLang {
+
+    std::optional<OptLevel> parseOptLevel(std::string_view flag) {
+        if (flag == "-O0") return OptLevel::O0;
+        if (flag == "-O1") return OptLevel::O1;
+        if (flag == "-O2") return OptLevel::O2;
+        if (flag == "-O3") return OptLevel::O3;
+        if (flag == "-Os") return OptLevel::Os;
+        return std::nullopt;
+    }
+
+    namespace {
+        llvm::CodeGenOptLevel codeGenLevel(OptLevel level) {
+            switch (level) {
+            case OptLevel::O0: return llvm::CodeGenOptLevel::None;
+            case OptLevel::O1: return llvm::CodeGenOptLevel::Less;
+            case OptLevel::O3: return llvm::CodeGenOptLevel::Aggressive;
+            case OptLevel::O2:
+            case OptLevel::Os: return llvm::CodeGenOptLevel::Default;
+            }
+            return llvm::CodeGenOptLevel::Default;
+        }
+
+        llvm::OptimizationLevel pipelineLevel(OptLevel level) {
+            switch (level) {
+            case OptLevel::O0: return llvm::OptimizationLevel::O0;
+            case OptLevel::O1: return llvm::OptimizationLevel::O1;
+            case OptLevel::O2: return llvm::OptimizationLevel::O2;
+            case OptLevel::O3: return llvm::OptimizationLevel::O3;
+            case OptLevel::Os: return llvm::OptimizationLevel::Os;
+            }
+            return llvm::OptimizationLevel::O2;
+        }
+    }
+
+    std::unique_ptr<llvm::TargetMachine> createHostTargetMachine(OptLevel level) {
+        std::string triple = llvm::sys::getDefaultTargetTriple();
+
+        std::string error;
+        const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+        if (!target) {
+            throw std::runtime_error("Is machine ka target nahi mila (" + triple + "): " + error);
+        }
+
+        // Tune for the CPU we're running on, like -march=native
+        llvm::StringMap<bool> hostFeatures;
+        std::string features;
+        if (llvm::sys::getHostCPUFeatures(hostFeatures)) {
+            for (const auto& feature : hostFeatures) {
+                features += (feature.getValue() ? "+" : "-") + feature.getKey().str() + ",";
+            }
+        }
+
+        std::unique_ptr<llvm::TargetMachine> machine(target->createTargetMachine(
+            triple, llvm::sys::getHostCPUName(), features, llvm::TargetOptions(),
+            llvm::Reloc::PIC_, std::nullopt, codeGenLevel(level)));
+        if (!machine) {
+            throw std::runtime_error("TargetMachine nahi bani for " + triple);
+        }
+        return machine;
+    }
+
+    llvm::TargetMachine& threadTargetMachine(OptLevel level) {
+        thread_local std::unique_ptr<llvm::TargetMachine> machine;
+        thread_local OptLevel machineLevel;
+        if (!machine || machineLevel != level) {
+            machine = createHostTargetMachine(level);
+            machineLevel = level;
+        }
+        return *machine;
+    }
+
+    std::string runtimeBitcodePath() {
+        if (const char* path = std::getenv("AWARA_RUNTIME_BC")) {
+            return path;
+        }
+        return AWARA_RUNTIME_BITCODE;
+    }
+
+    bool linkRuntimeBitcode(llvm::Module& module) {
+        std::string path = runtimeBitcodePath();
+        if (!llvm::sys::fs::exists(path)) {
+            return false;
+        }
+
+        llvm::SMDiagnostic diagnostic;
+        std::unique_ptr<llvm::Module> runtime = llvm::parseIRFile(path, diagnostic, module.getContext());
+        if (!runtime) {
+            throw std::runtime_error("Runtime bitcode nahi padha " + path + ": " + diagnostic.getMessage().str());
+        }
+
+        // Like -flto: only what the program calls comes in, and it becomes
+        // internal so it can be inlined and then dropped
+        bool failed = llvm::Linker::linkModules(module, std::move(runtime), llvm::Linker::Flags::LinkOnlyNeeded,
+            [](llvm::Module& linked, const llvm::StringSet<>& imported) {
+                llvm::internalizeModule(linked, [&imported](const llvm::GlobalValue& value) {
+                    return !value.hasName() || !imported.count(value.getName());
+                });
+            });
+        if (failed) {
+            throw std::runtime_error("Runtime bitcode link nahi hua: " + path);
+        }
+        return true;
+    }
+
+    void optimizeModule(llvm::Module& module, llvm::TargetMachine& target, OptLevel level, bool printTimings) {
+        module.setTargetTriple(target.getTargetTriple().str());
+        module.setDataLayout(target.createDataLayout());
+
+        // Checked when the timing instrumentation is constructed. It's a
+        // global, so only touch it when asked: modules optimize in parallel.
+        if (printTimings) {
+            llvm::TimePassesIsEnabled = true;
+        }
+
+        llvm::LoopAnalysisManager loopAnalyses;
+        llvm::FunctionAnalysisManager functionAnalyses;
+        llvm::CGSCCAnalysisManager cgsccAnalyses;
+        llvm::ModuleAnalysisManager moduleAnalyses;
+
+        llvm::PassInstrumentationCallbacks callbacks;
+        llvm::StandardInstrumentations instrumentations(module.getContext(), false);
+        instrumentations.registerCallbacks(callbacks, &moduleAnalyses);
+
+        // Same vectorizer defaults as clang: on from -O2, and for -Os
+        llvm::PipelineTuningOptions tuning;
+        bool vectorize = level == OptLevel::O2 || level == OptLevel::O3 || level == OptLevel::Os;
+        tuning.LoopVectorization = vectorize;
+        tuning.SLPVectorization = vectorize;
+        tuning.LoopUnrolling = level != OptLevel::Os;
+
+        llvm::PassBuilder builder(&target, tuning, std::nullopt, &callbacks);
+        builder.registerModuleAnalyses(moduleAnalyses);
+        builder.registerCGSCCAnalyses(cgsccAnalyses);
+        builder.registerFunctionAnalyses(functionAnalyses);
+        builder.registerLoopAnalyses(loopAnalyses);
+        builder.crossRegisterProxies(loopAnalyses, functionAnalyses, cgsccAnalyses, moduleAnalyses);
+
+        llvm::ModulePassManager passes = level == OptLevel::O0
+            ? builder.buildO0DefaultPipeline(llvm::OptimizationLevel::O0)
+            : builder.buildPerModuleDefaultPipeline(pipelineLevel(level));
+        passes.run(module, moduleAnalyses);
+
+        if (printTimings) {
+            llvm::reportAndResetTimings(&llvm::errs());
+            llvm::TimePassesIsEnabled = false;
+        }
+    }
+
+} // namespace CustomLang
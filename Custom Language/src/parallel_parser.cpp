@@ -0,0 +1,106 @@
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory>
+
+namespace CustomLang {
+
+    namespace {
+        // Below this a chunk isn't worth a task
+        constexpr size_t MIN_CHUNK_TOKENS = 16 * 1024;
+
+        // A few chunks per worker keeps the pool busy when chunk costs differ
+        constexpr size_t CHUNKS_PER_WORKER = 4;
+
+        struct ChunkResult {
+            std::unique_ptr<AstArena> arena;
+            StatementList statements;
+        };
+    }
+
+    std::vector<std::pair<size_t, size_t>> splitTopLevel(const TokenBuffer& tokens, size_t minTokens) {
+        std::vector<std::pair<size_t, size_t>> chunks;
+        size_t chunkStart = 0;
+        size_t depth = 0;
+
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            switch (tokens.kind(i)) {
+            case TokenType::LEFT_BRACE:
+                depth++;
+                break;
+            case TokenType::RIGHT_BRACE:
+                if (depth > 0) depth--;
+                break;
+            case TokenType::DEKH:
+                if (depth == 0 && i - chunkStart >= minTokens) {
+                    chunks.emplace_back(chunkStart, i);
+                    chunkStart = i;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        chunks.emplace_back(chunkStart, tokens.size());
+        return chunks;
+    }
+
+    StatementList parseParallel(const TokenBuffer& tokens, AstArena& arena, ThreadPool& pool) {
+        size_t target = tokens.size() / (static_cast<size_t>(pool.size()) * CHUNKS_PER_WORKER);
+        auto chunks = splitTopLevel(tokens, std::max(target, MIN_CHUNK_TOKENS));
+
+        if (chunks.size() == 1 || pool.size() == 1) {
+            return Parser(tokens, arena).parse();
+        }
+
+        bool timed = arena.timed();
+        std::vector<std::future<ChunkResult>> pending;
+        pending.reserve(chunks.size());
+
+        for (const auto& chunk : chunks) {
+            pending.push_back(pool.submit([&tokens, chunk, timed] {
+                ChunkResult result{ std::make_unique<AstArena>(), StatementList() };
+                result.arena->setTimed(timed);
+
+                Parser parser(tokens, *result.arena, chunk.first, chunk.second);
+                parser.setReportErrors(false);
+                result.statements = StatementList(parser.parse(), result.arena.get());
+                return result;
+            }));
+        }
+
+        // Collect every chunk before deciding, so no task outlives `tokens`
+        std::vector<ChunkResult> results;
+        results.reserve(pending.size());
+        bool failed = false;
+        for (auto& future : pending) {
+            try {
+                results.push_back(future.get());
+            } catch (const std::exception&) {
+                failed = true;
+            }
+        }
+
+        if (failed) {
+            return Parser(tokens, arena).parse();
+        }
+
+        size_t total = 0;
+        for (const ChunkResult& result : results) {
+            total += result.statements.size();
+        }
+
+        StatementList statements(&arena);
+        statements.reserve(total);
+        for (ChunkResult& result : results) {
+            statements.insert(statements.end(), result.statements.begin(), result.statements.end());
+            arena.adopt(std::move(result.arena));
+        }
+
+        return statements;
+    }
+
+} // namespace CustomLang
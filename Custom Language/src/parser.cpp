@@ -12,12 +12,58 @@ namespace CustomLang {
 
 // Advance to the next token
 void Parser::advance() {
-    current_token_ = lexer_.nextToken();
+    if (tokens_) {
+        // The buffer's last token is EOF; a sub-range ends in it as well
+        current_ = &tokens_->packed(position_ < end_ ? position_ : tokens_->size() - 1);
+        position_++;
+        return;
+    }
+
+    if (!lookahead_.empty()) {
+        streamed_ = lookahead_.front();
+        lookahead_.pop_front();
+    } else {
+        streamed_ = lexer_.nextToken();
+    }
+    streamedPacked_ = PackedToken::pack(streamed_, source_);
+    current_ = &streamedPacked_;
+}
+
+// Look ahead without consuming
+Token Parser::peek(size_t n) {
+    if (tokens_) {
+        // position_ is one past the current token
+        size_t index = position_ + n - 1;
+        return tokens_->token(index < end_ ? index : tokens_->size() - 1);
+    }
+
+    if (n == 0) return streamed_;
+
+    // Streaming mode buffers tokens until they are consumed; EOF repeats
+    while (lookahead_.size() < n) {
+        if (!lookahead_.empty() && lookahead_.back().type == TokenType::EOF_TOKEN) {
+            return lookahead_.back();
+        }
+        if (lookahead_.empty() && streamed_.type == TokenType::EOF_TOKEN) {
+            return streamed_;
+        }
+        lookahead_.push_back(lexer_.nextToken());
+    }
+    return lookahead_[n - 1];
+}
+
+// Parse the whole input into top-level statements
+StatementList Parser::parse() {
+    StatementList statements(&arena_);
+    while (currentType() != TokenType::EOF_TOKEN) {
+        statements.push_back(parseStatement());
+    }
+    return statements;
 }
 
 // Match a token type and advance if matched
 bool Parser::match(TokenType type) {
-    if (current_token_.type == type) {
+    if (currentType() == type) {
         advance();
         return true;
     }
@@ -33,97 +79,96 @@ void Parser::logError(const std::string& baseMessage, const std::string& context
     if (!suggestion.empty()) {
         oss << "\n" << colorize("Socho iske baare mein: ", GREEN) << suggestion;
     }
-    std::cerr << oss.str() << "\n" << std::endl;
+    if (reportErrors_) {
+        std::cerr << oss.str() << "\n" << std::endl;
+    }
     throw std::runtime_error(oss.str());
 }
 
-// Expect a specific token type, or add an error if it doesn't match
-void Parser::expect(TokenType type, const std::string& errorMessage) {
-    if (!match(type)) {
-        logError(colorize(errorMessage, RED),
-                colorize(current_token_.lexeme, GREEN),
-                colorize("Dekho syntax sahi hai kya?", CYAN));
-    }
+// Report a token that didn't match what expect() wanted
+void Parser::expectFailed(const std::string& errorMessage) {
+    logError(colorize(errorMessage, RED),
+            colorize(std::string(currentLexeme()), GREEN),
+            colorize("Dekho syntax sahi hai kya?", CYAN));
 }
 
 // Parse a single statement
-std::unique_ptr<Statement> Parser::parseStatement() {
-    switch (current_token_.type) {
+Statement* Parser::parseStatement() {
+    switch (currentType()) {
         case TokenType::DIKHA_BHAI:
             return parsePrintStatement();
         case TokenType::DEKH:
             return parseFunctionDeclaration();
         default:
             logError(colorize("Ooo Bhai kaha? Kya chala rha h? ", RED),
-                    colorize(current_token_.lexeme, GREEN));
+                    colorize(std::string(currentLexeme()), GREEN));
             return nullptr;
     }
 }
 
 
 // Parse a print statement
-std::unique_ptr<Statement> Parser::parsePrintStatement() {
-    expect( TokenType::DIKHA_BHAI,
-            colorize("Kya bhai shi se bta to dikhane ko - ", RED) + colorize("'dikha bhai'", MAGENTA));
+Statement* Parser::parsePrintStatement() {
+    expect( TokenType::DIKHA_BHAI, [] {
+            return colorize("Kya bhai shi se bta to dikhane ko - ", RED) + colorize("'dikha bhai'", MAGENTA); });
     auto expression = parseExpression();
-    return std::make_unique<PrintStatement>(std::move(expression));
+    return arena_.create<PrintStatement>(expression);
 }
 
 // Parse a function declaration
-std::unique_ptr<Statement> Parser::parseFunctionDeclaration() {
-    expect( TokenType::DEKH,
-            colorize("Bhai agar kuch bta rhe ho to bta to do, ", RED) +
-            colorize("'dekh'", MAGENTA)
-        );
+Statement* Parser::parseFunctionDeclaration() {
+    expect( TokenType::DEKH, [] {
+            return colorize("Bhai agar kuch bta rhe ho to bta to do, ", RED) +
+                   colorize("'dekh'", MAGENTA);
+        });
 
     // Parse function name
-    if (current_token_.type == TokenType::IDENTIFIER) {
-    std::string functionName = current_token_.lexeme;
+    if (currentType() == TokenType::IDENTIFIER) {
+    SymbolId functionName = currentSymbol();
     advance();
 
     // Parse parameters
-    expect( TokenType::LEFT_PAREN, 
-            colorize("Kya be ", BOLD_RED) +
-            colorize("'(' ", BOLD_GREEN) +
-            colorize ("ke dali ho?", BOLD_RED)
-        );
+    expect( TokenType::LEFT_PAREN, [] {
+            return colorize("Kya be ", BOLD_RED) +
+                   colorize("'(' ", BOLD_GREEN) +
+                   colorize ("ke dali ho?", BOLD_RED);
+        });
 
-    std::vector<FunctionDecl::Param> params;
+    std::pmr::vector<FunctionDecl::Param> params(&arena_);
 
     while (!match(TokenType::RIGHT_PAREN)) {
 
         if (!params.empty()) {
-            expect( TokenType::COMMA,
-                    colorize("Tsk, tsk comma lga da ho marde - ", RED) +
-                    colorize(",", MAGENTA)
-                );
+            expect( TokenType::COMMA, [] {
+                    return colorize("Tsk, tsk comma lga da ho marde - ", RED) +
+                           colorize(",", MAGENTA);
+                });
         }
 
-        expect(TokenType::IDENTIFIER, colorize("Parameter name to daal!", BOLD_RED));
-        std::string paramName = current_token_.lexeme;
-        advance();
-        expect(TokenType::IDENTIFIER, colorize("Parameter name to daal!", BOLD_RED));
-        std::string paramType = current_token_.lexeme;
+        // name type, e.g. (x int, naam string)
+        SymbolId paramName = currentSymbol();
+        expect(TokenType::IDENTIFIER, [] { return colorize("Parameter name to daal!", BOLD_RED); });
+        SymbolId paramType = parseTypeName();
         params.emplace_back(FunctionDecl::Param{paramName, paramType});
     }
 
     // Parse function body
-    expect( TokenType::LEFT_BRACE,
-            colorize("'{'", BOLD_MAGENTA) +
-            colorize(" ye to lga do", BLUE)
-        );
-    std::vector<std::unique_ptr<Statement>> body;
+    expect( TokenType::LEFT_BRACE, [] {
+            return colorize("'{'", BOLD_MAGENTA) +
+                   colorize(" ye to lga do", BLUE);
+        });
+    StatementList body(&arena_);
     while (!match(TokenType::RIGHT_BRACE)) {
         body.push_back(parseStatement());
     }
 
-    return std::make_unique<FunctionDecl>(functionName, params, std::move(body));
+    return arena_.create<FunctionDecl>(functionName, std::move(params), std::move(body));
     } 
     
    else {
         logError(
             colorize("Kya bta rhe ho? Naam to define kro! ", BOLD_CYAN) +
-            current_token_.lexeme, 
+            std::string(currentLexeme()), 
             colorize("'dekh' ", RED) +
             colorize("ke baad naam hona chahiye.", BOLD_CYAN)
         );
@@ -132,61 +177,82 @@ std::unique_ptr<Statement> Parser::parseFunctionDeclaration() {
 }
 
 // Parse an expression
-std::unique_ptr<Expression> Parser::parseExpression() {
+Expression* Parser::parseExpression() {
     return parseBinaryExpression();
 }
 
 // Parse a binary expression
-std::unique_ptr<Expression> Parser::parseBinaryExpression(int precedence) {
+Expression* Parser::parseBinaryExpression(int precedence) {
     auto left = parsePrimary();
 
     while (true) {
-        int tokenPrecedence = getPrecedence(current_token_.type);
-        if (tokenPrecedence < precedence) {
+        int tokenPrecedence = getPrecedence(currentType());
+        // Precedence 0 means "not a binary operator"
+        if (tokenPrecedence == 0 || tokenPrecedence < precedence) {
             break;
         }
 
-        std::string op = current_token_.lexeme;
+        // Only 'aur' and 'ya' have a precedence
+        BinaryOp op = currentType() == TokenType::AUR ? BinaryOp::AUR : BinaryOp::YA;
         advance();
 
         auto right = parseBinaryExpression(tokenPrecedence + 1);
-        left = std::make_unique<BinaryExpr>(std::move(left), op, std::move(right));
+        left = arena_.create<BinaryExpr>(left, op, right);
     }
 
     return left;
 }
 
 // Parse a primary expression
-std::unique_ptr<Expression> Parser::parsePrimary() {
-    switch (current_token_.type) {
+Expression* Parser::parsePrimary() {
+    switch (currentType()) {
         case TokenType::NUMBER_LITERAL:
         case TokenType::STRING_LITERAL:
         case TokenType::BOOLEAN_LITERAL:
         case TokenType::KHALI:
             return parseLiteral();
         default:
-            logError(colorize("Kuch to hua: ", GREEN), current_token_.lexeme);
+            logError(colorize("Kuch to hua: ", GREEN), std::string(currentLexeme()));
             return nullptr;
     }
 }
 
+// Parse a parameter type keyword into its symbol
+SymbolId Parser::parseTypeName() {
+    SymbolId type = INVALID_SYMBOL;
+    switch (currentType()) {
+        case TokenType::INT:    type = Symbols::INT; break;
+        case TokenType::STRING: type = Symbols::STRING; break;
+        case TokenType::FLOAT:  type = Symbols::FLOAT; break;
+        case TokenType::BOOL:   type = Symbols::BOOL; break;
+        default:
+            logError(colorize("Parameter ka type to daal! ", BOLD_RED) +
+                     colorize("(int, string, float, bool)", MAGENTA),
+                    colorize(std::string(currentLexeme()), GREEN));
+            return INVALID_SYMBOL;
+    }
+    advance();
+    return type;
+}
+
 // Parse a literal expression
-std::unique_ptr<Expression> Parser::parseLiteral() {
-    std::string value = current_token_.lexeme;
-    TokenType type = current_token_.type;
+Expression* Parser::parseLiteral() {
+    SymbolId value = currentSymbol();
+    TokenType type = currentType();
+    std::string_view lexeme = currentLexeme();
 
     advance(); // Consume the literal token
 
     if (type == TokenType::NUMBER_LITERAL) {
-        return std::make_unique<LiteralExpr>(LiteralExpr::LiteralType::NUMBER, value);
+        return arena_.create<LiteralExpr>(LiteralExpr::LiteralType::NUMBER, value);
     } else if (type == TokenType::STRING_LITERAL) {
-        return std::make_unique<LiteralExpr>(LiteralExpr::LiteralType::STRING, value);
+        return arena_.create<LiteralExpr>(LiteralExpr::LiteralType::STRING, value);
     } else if (type == TokenType::BOOLEAN_LITERAL) {
-        return std::make_unique<LiteralExpr>(LiteralExpr::LiteralType::BOOLEAN, value);
+        return arena_.create<LiteralExpr>(LiteralExpr::LiteralType::BOOLEAN, value);
     } else if (type == TokenType::KHALI) {
-        return std::make_unique<LiteralExpr>(LiteralExpr::LiteralType::KHALI, "khali");
+        return arena_.create<LiteralExpr>(LiteralExpr::LiteralType::KHALI, Symbols::KHALI);
     } else {
-        logError(colorize("Kya kr rha h bhai tu? Syntax to dhang se daalna seekh le", RED), value);
+        logError(colorize("Kya kr rha h bhai tu? Syntax to dhang se daalna seekh le", RED), std::string(lexeme));
         return nullptr;
     }
 }
@@ -1,5 +1,6 @@
 #include "runtime.hpp"
 #include <iostream>
+#include <cstdio>
 #include <cstdlib>
 #include <stdexcept>
 #include <unordered_set>
@@ -10,7 +11,7 @@ namespace CustomLang {
 
     void Runtime::initialize() {
         
-        gc = GarbageCollector::getInstance();
+        GarbageCollector::getInstance();
 
     }
 
@@ -49,6 +50,14 @@ namespace CustomLang {
         return ptr;
     }
 
+    void* Runtime::allocateLongLived(size_t size) {
+        void* ptr = gc.allocateOld(size);
+        if (!ptr) {
+            throw std::runtime_error("Memory allocation failed");
+        }
+        return ptr;
+    }
+
     void Runtime::freeMemory(void* ptr) {
         gc.removeRoot(ptr);
     }
@@ -61,6 +70,22 @@ namespace CustomLang {
         gc.collect();
     }
 
+    void Runtime::setGCPercent(int percent) {
+        gc.setGCPercent(percent);
+    }
+
+    void Runtime::setMemoryLimit(size_t bytes) {
+        gc.setMemoryLimit(bytes);
+    }
+
+    void Runtime::registerThread() {
+        gc.attachThread();
+    }
+
+    void Runtime::unregisterThread() {
+        gc.detachThread();
+    }
+
     bool Runtime::isKhali(void* ptr) {
         return ptr == nullptr;
     }
@@ -74,4 +99,71 @@ namespace CustomLang {
         throw std::runtime_error(message);
     }
 
-} // namespace CustomLang
\ No newline at end of file
+    std::vector<std::pair<const char*, void*>> Runtime::symbols() {
+        return {
+            { "dikha_bhai",   reinterpret_cast<void*>(&dikha_bhai) },
+            { "dikha_number", reinterpret_cast<void*>(&dikha_number) },
+            { "GC_register",  reinterpret_cast<void*>(&GC_register) },
+            { "GC_allocate",  reinterpret_cast<void*>(&GC_allocate) },
+            { "GC_collect",   reinterpret_cast<void*>(&GC_collect) },
+            { "GC_pre_write_barrier", reinterpret_cast<void*>(&GC_pre_write_barrier) },
+            { "GC_write_barrier", reinterpret_cast<void*>(&GC_write_barrier) },
+            { "GC_safepoint",     reinterpret_cast<void*>(&GC_safepoint) },
+            { "GC_root_chain",    reinterpret_cast<void*>(&GC_root_chain) },
+
+            // Slow paths and data the inlined entry points use
+            { "awara_rt_write_line", reinterpret_cast<void*>(&awara_rt_write_line) },
+            { "awara_rt_add_root",   reinterpret_cast<void*>(&awara_rt_add_root) },
+            { "awara_rt_allocate",   reinterpret_cast<void*>(&awara_rt_allocate) },
+            { "awara_rt_collect",    reinterpret_cast<void*>(&awara_rt_collect) },
+            { "awara_rt_remember",   reinterpret_cast<void*>(&awara_rt_remember) },
+            { "awara_rt_shade",      reinterpret_cast<void*>(&awara_rt_shade) },
+            { "awara_rt_safepoint",  reinterpret_cast<void*>(&awara_rt_safepoint) },
+            { "awara_rt_root_chain", reinterpret_cast<void*>(&awara_rt_root_chain) },
+            { "awara_gc_nursery_start", reinterpret_cast<void*>(&awara_gc_nursery_start) },
+            { "awara_gc_nursery_end",   reinterpret_cast<void*>(&awara_gc_nursery_end) },
+            { "awara_gc_safepoint_requested", reinterpret_cast<void*>(&awara_gc_safepoint_requested) },
+            { "awara_gc_marking", reinterpret_cast<void*>(&awara_gc_marking) },
+        };
+    }
+
+} // namespace CustomLang
+
+extern "C" {
+
+    void awara_rt_write_line(const char* data, size_t length) {
+        // Through stdio rather than cout: no per-line flush, and stays in
+        // order with cout while the two are synced
+        std::fwrite(data, 1, length, stdout);
+        std::fputc('\n', stdout);
+    }
+
+    void awara_rt_add_root(void* ptr) {
+        CustomLang::Runtime::markRoot(ptr);
+    }
+
+    void* awara_rt_allocate(size_t size) {
+        return CustomLang::Runtime::allocateMemory(size);
+    }
+
+    void awara_rt_collect() {
+        CustomLang::Runtime::collectGarbage();
+    }
+
+    void awara_rt_remember(void* object) {
+        CustomLang::GarbageCollector::getInstance().remember(object);
+    }
+
+    void awara_rt_shade(void* object) {
+        CustomLang::GarbageCollector::getInstance().shade(object);
+    }
+
+    void awara_rt_safepoint() {
+        CustomLang::GarbageCollector::getInstance().safepoint();
+    }
+
+    awara_stack_entry** awara_rt_root_chain() {
+        return CustomLang::GarbageCollector::getInstance().rootChain();
+    }
+
+} // extern "C"
@@ -0,0 +1,77 @@
+// Kept free of C++ library headers: this file is also compiled to bitcode
+// and linked into user modules, so everything here should be cheap to inline.
+#include "runtime_abi.hpp"
+
+extern "C" {
+
+    void dikha_bhai(const char* message) {
+        if (!message) {
+            awara_rt_write_line("khali", 5);
+            return;
+        }
+        // Folds to a constant for string literals once inlined
+        awara_rt_write_line(message, __builtin_strlen(message));
+    }
+
+    void dikha_number(int32_t value) {
+        char buffer[12];
+        char* end = buffer + sizeof(buffer);
+        char* p = end;
+
+        uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+        do {
+            *--p = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (value < 0) {
+            *--p = '-';
+        }
+
+        awara_rt_write_line(p, static_cast<size_t>(end - p));
+    }
+
+    void GC_register(void* ptr) {
+        // Constants and khali are never heap objects
+        if (ptr) {
+            awara_rt_add_root(ptr);
+        }
+    }
+
+    void* GC_allocate(size_t size) {
+        return awara_rt_allocate(size ? size : 1);
+    }
+
+    void GC_collect() {
+        awara_rt_collect();
+    }
+
+    void GC_pre_write_barrier(void* previous) {
+        // Logs the old reference only while an incremental cycle marks
+        if (previous && __atomic_load_n(&awara_gc_marking, __ATOMIC_RELAXED)) {
+            awara_rt_shade(previous);
+        }
+    }
+
+    void GC_write_barrier(void* object, void* value) {
+        // Only old-to-young pointers need remembering. One unsigned compare
+        // per pointer; an empty range never matches.
+        uintptr_t start = awara_gc_nursery_start;
+        uintptr_t size = awara_gc_nursery_end - start;
+        if (reinterpret_cast<uintptr_t>(value) - start < size &&
+            reinterpret_cast<uintptr_t>(object) - start >= size) {
+            awara_rt_remember(object);
+        }
+    }
+
+    void GC_safepoint() {
+        // One load per poll until a collection asks threads to stop
+        if (__atomic_load_n(&awara_gc_safepoint_requested, __ATOMIC_ACQUIRE)) {
+            awara_rt_safepoint();
+        }
+    }
+
+    awara_stack_entry** GC_root_chain() {
+        return awara_rt_root_chain();
+    }
+
+}
@@ -0,0 +1,279 @@
+#include "scanner.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#define CUSTOMLANG_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(CUSTOMLANG_SCAN_X86) && defined(__GNUC__)
+#define CUSTOMLANG_SCAN_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace CustomLang {
+namespace scan {
+
+    namespace {
+
+        // ---- Scalar fallback ----
+
+        WhitespaceRun whitespaceScalar(const char* p, const char* end) {
+            WhitespaceRun run{p, 0, nullptr};
+            while (run.end < end && is(*run.end, CC_SPACE)) {
+                if (*run.end == '\n') {
+                    run.newlines++;
+                    run.lastNewline = run.end;
+                }
+                run.end++;
+            }
+            return run;
+        }
+
+        const char* identifierScalar(const char* p, const char* end) {
+            while (p < end && is(*p, CC_IDENT)) p++;
+            return p;
+        }
+
+        const char* digitsScalar(const char* p, const char* end) {
+            while (p < end && is(*p, CC_DIGIT)) p++;
+            return p;
+        }
+
+        const char* stringStopScalar(const char* p, const char* end) {
+            while (p < end && !is(*p, CC_STRING_STOP)) p++;
+            return p;
+        }
+
+#if defined(CUSTOMLANG_SCAN_X86)
+
+        inline unsigned countTrailingZeros(unsigned mask) {
+#if defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#endif
+        }
+
+        inline unsigned highestBit(unsigned mask) {
+#if defined(__GNUC__)
+            return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#else
+            unsigned long index;
+            _BitScanReverse(&index, mask);
+            return static_cast<unsigned>(index);
+#endif
+        }
+
+        inline int popCount(unsigned mask) {
+#if defined(__GNUC__)
+            return __builtin_popcount(mask);
+#else
+            return static_cast<int>(__popcnt(mask));
+#endif
+        }
+
+        // Folds one block's whitespace/newline masks into the run. Returns true
+        // once a non-whitespace byte has been found.
+        inline bool accumulateWhitespace(WhitespaceRun& run, const char* block,
+                                         unsigned spaceMask, unsigned newlineMask, unsigned fullMask) {
+            unsigned stop = ~spaceMask & fullMask;
+            unsigned length = stop ? countTrailingZeros(stop) : 0;
+            if (stop) {
+                newlineMask &= (1u << length) - 1;
+            }
+            if (newlineMask) {
+                run.newlines += popCount(newlineMask);
+                run.lastNewline = block + highestBit(newlineMask);
+            }
+            if (stop) {
+                run.end = block + length;
+                return true;
+            }
+            return false;
+        }
+
+        // ---- SSE2 (baseline on x86-64) ----
+
+        // Bytes in [lo, hi]; bytes >= 0x80 compare negative and never match
+        inline __m128i inRange16(__m128i v, char lo, char hi) {
+            return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                                 _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+        }
+
+        WhitespaceRun whitespaceSse2(const char* p, const char* end) {
+            WhitespaceRun run{p, 0, nullptr};
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i newline = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+                __m128i space = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), newline));
+                if (accumulateWhitespace(run, p,
+                        static_cast<unsigned>(_mm_movemask_epi8(space)),
+                        static_cast<unsigned>(_mm_movemask_epi8(newline)), 0xFFFFu)) {
+                    return run;
+                }
+            }
+
+            WhitespaceRun tail = whitespaceScalar(p, end);
+            run.end = tail.end;
+            run.newlines += tail.newlines;
+            if (tail.lastNewline) run.lastNewline = tail.lastNewline;
+            return run;
+        }
+
+        const char* identifierSse2(const char* p, const char* end) {
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i letter = inRange16(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+                __m128i ident = _mm_or_si128(
+                    _mm_or_si128(letter, inRange16(v, '0', '9')),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))));
+                unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(ident)) & 0xFFFFu;
+                if (stop) return p + countTrailingZeros(stop);
+            }
+            return identifierScalar(p, end);
+        }
+
+        const char* digitsSse2(const char* p, const char* end) {
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(inRange16(v, '0', '9'))) & 0xFFFFu;
+                if (stop) return p + countTrailingZeros(stop);
+            }
+            return digitsScalar(p, end);
+        }
+
+        const char* stringStopSse2(const char* p, const char* end) {
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hit = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                    _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+                if (mask) return p + countTrailingZeros(mask);
+            }
+            return stringStopScalar(p, end);
+        }
+
+#endif // CUSTOMLANG_SCAN_X86
+
+#if defined(CUSTOMLANG_SCAN_AVX2)
+
+        // ---- AVX2 ----
+
+        TARGET_AVX2 inline __m256i inRange32(__m256i v, char lo, char hi) {
+            return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                                    _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+        }
+
+        TARGET_AVX2 WhitespaceRun whitespaceAvx2(const char* p, const char* end) {
+            WhitespaceRun run{p, 0, nullptr};
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i newline = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+                __m256i space = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), newline));
+                if (accumulateWhitespace(run, p,
+                        static_cast<unsigned>(_mm256_movemask_epi8(space)),
+                        static_cast<unsigned>(_mm256_movemask_epi8(newline)), 0xFFFFFFFFu)) {
+                    return run;
+                }
+            }
+
+            WhitespaceRun tail = whitespaceSse2(p, end);
+            run.end = tail.end;
+            run.newlines += tail.newlines;
+            if (tail.lastNewline) run.lastNewline = tail.lastNewline;
+            return run;
+        }
+
+        TARGET_AVX2 const char* identifierAvx2(const char* p, const char* end) {
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i letter = inRange32(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+                __m256i ident = _mm256_or_si256(
+                    _mm256_or_si256(letter, inRange32(v, '0', '9')),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'))));
+                unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+                if (stop) return p + countTrailingZeros(stop);
+            }
+            return identifierSse2(p, end);
+        }
+
+        TARGET_AVX2 const char* digitsAvx2(const char* p, const char* end) {
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(inRange32(v, '0', '9')));
+                if (stop) return p + countTrailingZeros(stop);
+            }
+            return digitsSse2(p, end);
+        }
+
+        TARGET_AVX2 const char* stringStopAvx2(const char* p, const char* end) {
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i hit = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+                if (mask) return p + countTrailingZeros(mask);
+            }
+            return stringStopSse2(p, end);
+        }
+
+#endif // CUSTOMLANG_SCAN_AVX2
+
+        struct Implementation {
+            const char* name;
+            WhitespaceRun (*whitespace)(const char*, const char*);
+            const char* (*identifier)(const char*, const char*);
+            const char* (*digits)(const char*, const char*);
+            const char* (*stringStop)(const char*, const char*);
+        };
+
+        Implementation selectImplementation() {
+#if defined(CUSTOMLANG_SCAN_AVX2)
+            if (__builtin_cpu_supports("avx2")) {
+                return { "avx2", whitespaceAvx2, identifierAvx2, digitsAvx2, stringStopAvx2 };
+            }
+#endif
+#if defined(CUSTOMLANG_SCAN_X86)
+            return { "sse2", whitespaceSse2, identifierSse2, digitsSse2, stringStopSse2 };
+#else
+            return { "scalar", whitespaceScalar, identifierScalar, digitsScalar, stringStopScalar };
+#endif
+        }
+
+        const Implementation& implementation() {
+            static const Implementation impl = selectImplementation();
+            return impl;
+        }
+
+    } // namespace
+
+    WhitespaceRun skipWhitespace(const char* p, const char* end) {
+        return implementation().whitespace(p, end);
+    }
+
+    const char* skipIdentifier(const char* p, const char* end) {
+        return implementation().identifier(p, end);
+    }
+
+    const char* skipDigits(const char* p, const char* end) {
+        return implementation().digits(p, end);
+    }
+
+    const char* findStringStop(const char* p, const char* end) {
+        return implementation().stringStop(p, end);
+    }
+
+    const char* implementationName() {
+        return implementation().name;
+    }
+
+} // namespace scan
+} // namespace CustomLang
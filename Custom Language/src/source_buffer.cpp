@@ -0,0 +1,145 @@
+#include "source_buffer.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CustomLang {
+
+    namespace {
+        constexpr size_t READ_CHUNK = 64 * 1024;
+
+        std::runtime_error systemError(const std::string& what, const std::string& path) {
+            return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+        }
+    }
+
+    SourceBuffer::~SourceBuffer() {
+        release();
+    }
+
+    SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          mapped_(std::exchange(other.mapped_, false)) {}
+
+    SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            mapped_ = std::exchange(other.mapped_, false);
+        }
+        return *this;
+    }
+
+    void SourceBuffer::release() {
+        if (!data_) return;
+
+        if (mapped_) {
+            munmap(data_, size_);
+        } else {
+            std::free(data_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+    }
+
+    SourceBuffer SourceBuffer::open(const std::string& path) {
+        if (path == "-") {
+            return readStream(STDIN_FILENO);
+        }
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw systemError("Could not open", path);
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int savedErrno = errno;
+            ::close(fd);
+            errno = savedErrno;
+            throw systemError("Could not stat", path);
+        }
+
+        // Pipes, FIFOs and devices don't have a size we can map
+        if (!S_ISREG(info.st_mode)) {
+            try {
+                SourceBuffer buffer = readStream(fd);
+                ::close(fd);
+                return buffer;
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+        }
+
+        SourceBuffer buffer;
+        if (info.st_size > 0) {
+            size_t size = static_cast<size_t>(info.st_size);
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                int savedErrno = errno;
+                ::close(fd);
+                errno = savedErrno;
+                throw systemError("Could not map", path);
+            }
+
+            // The lexer makes one front-to-back pass
+            madvise(mapping, size, MADV_SEQUENTIAL);
+
+            buffer.data_ = static_cast<char*>(mapping);
+            buffer.size_ = size;
+            buffer.mapped_ = true;
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+        return buffer;
+    }
+
+    SourceBuffer SourceBuffer::readStream(int fd) {
+        SourceBuffer buffer;
+        size_t capacity = 0;
+
+        while (true) {
+            if (capacity - buffer.size_ < READ_CHUNK) {
+                // realloc can usually grow large blocks in place (mremap), so we
+                // avoid holding two copies while the buffer grows
+                size_t newCapacity = capacity ? capacity * 2 : READ_CHUNK;
+                char* grown = static_cast<char*>(std::realloc(buffer.data_, newCapacity));
+                if (!grown) {
+                    throw std::runtime_error("Out of memory while reading source");
+                }
+                buffer.data_ = grown;
+                capacity = newCapacity;
+            }
+
+            ssize_t count = ::read(fd, buffer.data_ + buffer.size_, capacity - buffer.size_);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                throw systemError("Could not read", fd == STDIN_FILENO ? "<stdin>" : "<stream>");
+            }
+            if (count == 0) break;
+            buffer.size_ += static_cast<size_t>(count);
+        }
+
+        // Give back the unused tail
+        if (buffer.size_ > 0 && buffer.size_ < capacity) {
+            if (char* shrunk = static_cast<char*>(std::realloc(buffer.data_, buffer.size_))) {
+                buffer.data_ = shrunk;
+            }
+        }
+
+        return buffer;
+    }
+
+} // namespace CustomLang
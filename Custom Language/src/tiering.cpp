@@ -0,0 +1,91 @@
+#include "tiering.hpp"
+#include "codegen.hpp"
+#include "optimizer.hpp"
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+namespace CustomLang {
+
+    TierManager::TierManager(const FlatAST& ast, const BytecodeProgram& program, uint32_t threshold, bool log)
+        : ast_(ast), program_(program), threshold_(threshold), log_(log),
+          functions_(std::make_unique<FunctionState[]>(program.functions.size())) {}
+
+    TierManager::~TierManager() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    void TierManager::requestCompile(size_t index) {
+        const BytecodeFunction& function = program_.functions[index];
+        if (function.root == BytecodeFunction::NO_ROOT) {
+            return;
+        }
+
+        // Native entries are called without arguments
+        if (ast_.function(ast_.roots[function.root]).paramCount != 0) {
+            if (log_) {
+                std::cerr << "[tier-up] " << function.name << ": has parameters, stays interpreted" << std::endl;
+            }
+            return;
+        }
+
+        if (log_) {
+            std::cerr << "[tier-up] " << function.name << ": " << threshold_ << " calls, compiling" << std::endl;
+        }
+        compiler_.submit([this, index] { compile(index); });
+    }
+
+    void TierManager::compile(size_t index) {
+        if (cancelled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const BytecodeFunction& function = program_.functions[index];
+        auto start = std::chrono::steady_clock::now();
+
+        try {
+            CodeGenerator generator;
+            std::unique_ptr<llvm::Module> module = generator.generateFunction(ast_, function.root);
+
+            // The function's symbol (main is emitted under another name)
+            std::string symbol;
+            for (const llvm::Function& defined : *module) {
+                if (!defined.isDeclaration()) {
+                    symbol = defined.getName().str();
+                }
+            }
+
+            // Optimizing and JIT codegen are the slow parts; skip them once the
+            // program has ended
+            if (cancelled_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            std::unique_ptr<llvm::TargetMachine> target = createHostTargetMachine(OptLevel::O2);
+            linkRuntimeBitcode(*module);
+            optimizeModule(*module, *target, OptLevel::O2, false);
+            if (cancelled_.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            if (!jit_) {
+                jit_ = std::make_unique<Jit>();
+            }
+            jit_->addModule(std::move(module), generator.takeContext());
+            auto native = reinterpret_cast<NativeFunction>(jit_->lookup(symbol));
+
+            functions_[index].native.store(native, std::memory_order_release);
+
+            if (log_) {
+                std::cerr << "[tier-up] " << function.name << ": native after "
+                          << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0
+                          << " ms" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            // Not fatal: the function keeps running in the VM
+            if (log_) {
+                std::cerr << "[tier-up] " << function.name << ": failed, stays interpreted (" << e.what() << ")"
+                          << std::endl;
+            }
+        }
+    }
+
+} // namespace CustomLang
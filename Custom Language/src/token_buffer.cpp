@@ -0,0 +1,72 @@
+#include "token_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace CustomLang {
+
+    PackedToken PackedToken::pack(const Token& token, std::string_view source) {
+        if (token.lexeme.size() >= (1u << 24)) {
+            throw std::runtime_error("Token at line " + std::to_string(token.line) +
+                                     " is too long (16 MiB max)");
+        }
+
+        PackedToken packed;
+        packed.offset = static_cast<uint32_t>(token.lexeme.data() - source.data());
+        packed.lengthKind = static_cast<uint32_t>(token.lexeme.size()) << 8 |
+                            static_cast<uint32_t>(token.type);
+        packed.symbol = token.symbol;
+        return packed;
+    }
+
+    TokenBuffer TokenBuffer::lex(std::string_view source) {
+        if (source.size() > UINT32_MAX) {
+            throw std::runtime_error("Source file is too large for the token buffer (4 GiB max)");
+        }
+
+        TokenBuffer buffer;
+        buffer.source_ = source;
+        // Typical sources average a token every 6-10 bytes
+        buffer.tokens_.reserve(source.size() / 8 + 1);
+
+        Lexer lexer(source);
+        while (true) {
+            Token token = lexer.nextToken();
+            buffer.tokens_.push_back(PackedToken::pack(token, source));
+            if (token.type == TokenType::EOF_TOKEN) break;
+        }
+
+        buffer.lineStarts_.push_back(0);
+        const char* end = source.data() + source.size();
+        for (const char* p = source.data(); (p = static_cast<const char*>(std::memchr(p, '\n', end - p))); ) {
+            ++p;
+            buffer.lineStarts_.push_back(static_cast<uint32_t>(p - source.data()));
+        }
+
+        return buffer;
+    }
+
+    Token TokenBuffer::token(size_t index) const {
+        const PackedToken& packed = tokens_[index < tokens_.size() ? index : tokens_.size() - 1];
+
+        int line;
+        int column;
+        position(packed, line, column);
+
+        Token token(packed.kind(), lexeme(packed), line, column);
+        token.symbol = packed.symbol;
+        return token;
+    }
+
+    void TokenBuffer::position(const PackedToken& token, int& line, int& column) const {
+        // String literal lexemes start after the opening quote
+        uint32_t start = token.kind() == TokenType::STRING_LITERAL ? token.offset - 1 : token.offset;
+
+        // The last line starting at or before the token
+        auto next = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), start);
+        line = static_cast<int>(next - lineStarts_.begin());
+        column = static_cast<int>(start - *(next - 1)) + 1;
+    }
+
+} // namespace CustomLang
@@ -0,0 +1,137 @@
+#include "vm.hpp"
+#include "runtime.hpp"
+#include "tiering.hpp"
+
+#if defined(__GNUC__)
+#define AWARA_VM_COMPUTED_GOTO 1
+#endif
+
+namespace CustomLang {
+
+    VM::VM()
+        : trueText_(StringInterner::getInstance().name(Symbols::TRUE_)),
+          falseText_(StringInterner::getInstance().name(Symbols::FALSE_)) {}
+
+    void VM::print(const Value& value) {
+        switch (value.kind) {
+        case Value::Kind::NUMBER:
+            Runtime::print(std::to_string(value.number));
+            break;
+        case Value::Kind::STRING:
+            Runtime::print(value.string);
+            break;
+        case Value::Kind::BOOLEAN:
+            Runtime::print(value.boolean ? trueText_ : falseText_);
+            break;
+        case Value::Kind::KHALI:
+            Runtime::print("khali");
+            break;
+        }
+    }
+
+    void VM::run(const BytecodeProgram& program) {
+        struct Frame {
+            const uint32_t* returnPc;
+            size_t base;
+            uint32_t size;
+            const Value* constants;
+        };
+        std::vector<Frame> frames;
+
+        const BytecodeFunction& entry = program.functions[0];
+        size_t base = 0;
+        uint32_t size = entry.registerCount;
+        registers_.assign(size, Value{});
+
+        const uint32_t* pc = program.code.data() + entry.codeOffset;
+        const Value* k = program.constants.data() + entry.constantOffset;
+        Value* r = registers_.data();
+        uint32_t instruction;
+
+        using namespace bytecode;
+
+#if defined(AWARA_VM_COMPUTED_GOTO)
+        // Same order as OpCode
+        static void* const handlers[] = {
+            &&op_LOADK, &&op_AND, &&op_OR, &&op_PRINT, &&op_CALL, &&op_RET
+        };
+        static_assert(sizeof(handlers) / sizeof(handlers[0]) == static_cast<size_t>(OpCode::COUNT),
+                      "every opcode needs a handler");
+
+#define VM_CASE(name) op_##name:
+#define VM_NEXT() instruction = *pc++; goto *handlers[instruction & 0xFF]
+        VM_NEXT();
+#else
+#define VM_CASE(name) case OpCode::name:
+#define VM_NEXT() continue
+        for (;;) {
+            instruction = *pc++;
+            switch (op(instruction)) {
+#endif
+
+        VM_CASE(LOADK)
+            r[a(instruction)] = k[bx(instruction)];
+            VM_NEXT();
+
+        VM_CASE(AND)
+            r[a(instruction)].kind = Value::Kind::BOOLEAN;
+            r[a(instruction)].boolean = r[b(instruction)].boolean && r[c(instruction)].boolean;
+            VM_NEXT();
+
+        VM_CASE(OR)
+            r[a(instruction)].kind = Value::Kind::BOOLEAN;
+            r[a(instruction)].boolean = r[b(instruction)].boolean || r[c(instruction)].boolean;
+            VM_NEXT();
+
+        VM_CASE(PRINT)
+            print(r[a(instruction)]);
+            VM_NEXT();
+
+        VM_CASE(CALL) {
+            if (tiers_) {
+                if (TierManager::NativeFunction native = tiers_->enter(bx(instruction))) {
+                    native();
+                    VM_NEXT();
+                }
+            }
+
+            const BytecodeFunction& callee = program.functions[bx(instruction)];
+            frames.push_back(Frame{ pc, base, size, k });
+
+            base += size;
+            size = callee.registerCount;
+            if (registers_.size() < base + size) {
+                registers_.resize(base + size);
+            }
+            r = registers_.data() + base;
+            pc = program.code.data() + callee.codeOffset;
+            k = program.constants.data() + callee.constantOffset;
+            VM_NEXT();
+        }
+
+        VM_CASE(RET) {
+            if (frames.empty()) {
+                return;
+            }
+            const Frame& caller = frames.back();
+            pc = caller.returnPc;
+            base = caller.base;
+            size = caller.size;
+            k = caller.constants;
+            r = registers_.data() + base;
+            frames.pop_back();
+            VM_NEXT();
+        }
+
+#if !defined(AWARA_VM_COMPUTED_GOTO)
+            case OpCode::COUNT:
+                break;
+            }
+        }
+#endif
+
+#undef VM_CASE
+#undef VM_NEXT
+    }
+
+} // namespace CustomLang